@@ -0,0 +1,255 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#include "benchmarks/alloc_stats.hpp"
+
+#include "benchmarks/pool_alloc.hpp"
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+}
+
+namespace {
+
+bool g_enabled = false;
+std::atomic<uint64_t> g_allocs(0);
+std::atomic<uint64_t> g_bytes(0);
+std::atomic<int64_t> g_live(0);
+std::atomic<int64_t> g_peak(0);
+
+// Allocation without accounting: from the pool when it serves the request,
+// from glibc otherwise.
+void *RawMalloc(size_t size)
+{
+  void *ptr = PoolMalloc(size);
+  return ptr != nullptr ? ptr : __libc_malloc(size);
+}
+
+size_t RawUsableSize(void *ptr)
+{
+  return PoolOwns(ptr) ? PoolUsableSize(ptr) : malloc_usable_size(ptr);
+}
+
+void RawFree(void *ptr)
+{
+  if (PoolOwns(ptr)) {
+    PoolFree(ptr);
+  } else {
+    __libc_free(ptr);
+  }
+}
+
+// Pool blocks are never resized in place beyond their size class.
+void *RawRealloc(void *ptr, size_t size)
+{
+  if (!PoolOwns(ptr)) {
+    return ptr == nullptr ? RawMalloc(size) : __libc_realloc(ptr, size);
+  }
+
+  size_t usable = PoolUsableSize(ptr);
+  if (size == 0) {
+    PoolFree(ptr);
+    return nullptr;
+  }
+  if (size <= usable) {
+    return ptr;
+  }
+  void *new_ptr = RawMalloc(size);
+  if (new_ptr != nullptr) {
+    std::memcpy(new_ptr, ptr, usable);
+    PoolFree(ptr);
+  }
+  return new_ptr;
+}
+
+void OnAlloc(void *ptr, size_t size)
+{
+  if (!g_enabled || ptr == nullptr) {
+    return;
+  }
+
+  g_allocs.fetch_add(1, std::memory_order_relaxed);
+  g_bytes.fetch_add(size, std::memory_order_relaxed);
+  auto usable = static_cast<int64_t>(RawUsableSize(ptr));
+  int64_t live = g_live.fetch_add(usable, std::memory_order_relaxed) + usable;
+  int64_t peak = g_peak.load(std::memory_order_relaxed);
+  while (live > peak && !g_peak.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+    /* empty */;
+  }
+}
+
+size_t UsableSize(void *ptr)
+{
+  return g_enabled && ptr != nullptr ? RawUsableSize(ptr) : 0;
+}
+
+void OnFree(size_t usable)
+{
+  if (usable != 0) {
+    g_live.fetch_sub(static_cast<int64_t>(usable), std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+// The malloc family is defined here, so every allocation of the binary and of
+// the libraries it links (cdcontainers, Collections-C, glib, libstdc++) goes
+// through it and then to the pool (see pool_alloc.hpp) or the glibc allocator.
+extern "C" {
+void *malloc(size_t size) noexcept
+{
+  void *ptr = RawMalloc(size);
+  OnAlloc(ptr, size);
+  return ptr;
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+  size_t bytes = 0;
+  void *ptr = nullptr;
+  if (!__builtin_mul_overflow(count, size, &bytes) &&
+      (ptr = PoolMalloc(bytes)) != nullptr) {
+    std::memset(ptr, 0, bytes);
+  } else {
+    ptr = __libc_calloc(count, size);
+  }
+  OnAlloc(ptr, bytes);
+  return ptr;
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+  size_t usable = UsableSize(ptr);
+  void *new_ptr = RawRealloc(ptr, size);
+  if (new_ptr == nullptr && size != 0) {
+    // The old block is left untouched.
+    return nullptr;
+  }
+  OnFree(usable);
+  OnAlloc(new_ptr, size);
+  return new_ptr;
+}
+
+void free(void *ptr) noexcept
+{
+  OnFree(UsableSize(ptr));
+  RawFree(ptr);
+}
+
+void *memalign(size_t alignment, size_t size) noexcept
+{
+  void *ptr = __libc_memalign(alignment, size);
+  OnAlloc(ptr, size);
+  return ptr;
+}
+
+void *aligned_alloc(size_t alignment, size_t size) noexcept
+{
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept
+{
+  if (alignment % sizeof(void *) != 0 ||
+      (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+
+  void *new_ptr = memalign(alignment, size);
+  if (new_ptr == nullptr) {
+    return ENOMEM;
+  }
+  *ptr = new_ptr;
+  return 0;
+}
+}
+
+void EnableAllocStats(bool enable) { g_enabled = enable; }
+
+bool AllocStatsEnabled() { return g_enabled; }
+
+AllocStats GetAllocStats()
+{
+  AllocStats stats;
+  stats.allocs = g_allocs.load(std::memory_order_relaxed);
+  stats.bytes = g_bytes.load(std::memory_order_relaxed);
+  stats.live = g_live.load(std::memory_order_relaxed);
+  stats.peak = g_peak.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ResetAllocPeak()
+{
+  g_peak.store(g_live.load(std::memory_order_relaxed),
+               std::memory_order_relaxed);
+}
+
+void AllocCounters::Start()
+{
+  if (g_enabled) {
+    ResetAllocPeak();
+    _start = GetAllocStats();
+  }
+}
+
+void AllocCounters::Stop(size_t containers)
+{
+  if (!g_enabled) {
+    return;
+  }
+
+  AllocStats end = GetAllocStats();
+  _allocs += end.allocs - _start.allocs;
+  _bytes += end.bytes - _start.bytes;
+  _retained += end.live - _start.live;
+  // All containers of a batch are alive at once, so the peak of the batch is
+  // shared between them.
+  _peak = std::max(_peak, static_cast<double>(end.peak - _start.live) /
+                              static_cast<double>(containers));
+}
+
+void AllocCounters::Report(benchmark::State &state, double ops) const
+{
+  if (!g_enabled) {
+    return;
+  }
+
+  using benchmark::Counter;
+  state.counters["allocs"] =
+      Counter(static_cast<double>(_allocs) / ops, Counter::kAvgIterations);
+  state.counters["alloc_bytes"] =
+      Counter(static_cast<double>(_bytes) / ops, Counter::kAvgIterations);
+  state.counters["bytes_per_element"] =
+      Counter(static_cast<double>(_retained) / ops, Counter::kAvgIterations);
+  state.counters["peak_bytes"] = _peak;
+}
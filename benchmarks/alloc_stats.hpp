@@ -0,0 +1,64 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap usage of the process, collected by the malloc family interposed in
+// alloc_stats.cpp. Sizes of live blocks are usable sizes of the allocator.
+struct AllocStats {
+  uint64_t allocs;
+  uint64_t bytes;
+  int64_t live;
+  int64_t peak;
+};
+
+// Accounting is done only when enabled with --alloc_stats. RunBenchmarks()
+// restarts the binary with G_SLICE=always-malloc then, so glib nodes are
+// counted too.
+void EnableAllocStats(bool enable);
+bool AllocStatsEnabled();
+
+AllocStats GetAllocStats();
+
+// Starts a new peak from the current live bytes.
+void ResetAllocPeak();
+
+// Heap usage of timed regions, reported per operation.
+class AllocCounters
+{
+ public:
+  void Start();
+  void Stop(size_t containers);
+
+  // Sets counters averaged over iterations of `ops` operations.
+  void Report(benchmark::State &state, double ops) const;
+
+ private:
+  AllocStats _start = {};
+  uint64_t _allocs = 0;
+  uint64_t _bytes = 0;
+  int64_t _retained = 0;
+  double _peak = 0;
+};
@@ -0,0 +1,548 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+extern "C" {
+#include <cdcontainers/cdc.h>
+}
+
+#include <benchmark/benchmark.h>
+
+#include "benchmarks/deques.hpp"
+#include "benchmarks/maps.hpp"
+#include "benchmarks/utils.hpp"
+#include "benchmarks/workload.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+
+// Every thread runs its own slice of one shared operation sequence against
+// one shared container, so a run measures the throughput of the container
+// behind a lock as threads are added.
+constexpr size_t kOpsPerRun = 1 << 20;
+constexpr int kShardBits = 4;
+constexpr size_t kShards = 1 << kShardBits;
+
+// Guards expose the container to a callable under a lock:
+//   auto Read(int key, Fn fn);
+//   auto Write(int key, Fn fn);
+// The key picks the shard of sharded guards.
+template <class Container>
+class MutexGuarded
+{
+ public:
+  template <class... Args>
+  explicit MutexGuarded(Args... args) : _container(args...)
+  {
+  }
+
+  template <class Fn>
+  auto Read(int /* key */, Fn fn)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return fn(_container);
+  }
+
+  template <class Fn>
+  auto Write(int /* key */, Fn fn)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return fn(_container);
+  }
+
+ private:
+  std::mutex _mutex;
+  Container _container;
+};
+
+// Reads share the lock, so the container must not change on lookups (splay
+// trees do).
+template <class Container>
+class RwLockGuarded
+{
+ public:
+  template <class... Args>
+  explicit RwLockGuarded(Args... args) : _container(args...)
+  {
+  }
+
+  template <class Fn>
+  auto Read(int /* key */, Fn fn)
+  {
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return fn(_container);
+  }
+
+  template <class Fn>
+  auto Write(int /* key */, Fn fn)
+  {
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    return fn(_container);
+  }
+
+ private:
+  std::shared_mutex _mutex;
+  Container _container;
+};
+
+template <class Container>
+class ShardedGuarded
+{
+ public:
+  template <class... Args>
+  explicit ShardedGuarded(Args... args)
+  {
+    for (auto &shard : _shards) {
+      shard.reset(new Shard(args...));
+    }
+  }
+
+  template <class Fn>
+  auto Read(int key, Fn fn)
+  {
+    Shard &shard = *_shards[ShardIndex(key)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return fn(shard.container);
+  }
+
+  template <class Fn>
+  auto Write(int key, Fn fn)
+  {
+    return Read(key, fn);
+  }
+
+ private:
+  // Shards sit on their own cache lines, so threads on different shards do
+  // not share lines.
+  struct alignas(64) Shard {
+    template <class... Args>
+    explicit Shard(Args... args) : container(args...)
+    {
+    }
+
+    std::mutex mutex;
+    Container container;
+  };
+
+  // Takes the top bits of a multiplicative hash: the low bits of Hash() also
+  // pick the buckets of hash tables inside the shards.
+  static size_t ShardIndex(int key)
+  {
+    const auto hash = static_cast<uint64_t>(Hash(CDC_FROM_INT(key)));
+    return static_cast<size_t>((hash * UINT64_C(0x9e3779b97f4a7c15)) >>
+                               (64 - kShardBits));
+  }
+
+  std::unique_ptr<Shard> _shards[kShards];
+};
+
+static int GetMaxThreads()
+{
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+// Thread 0 builds the container and the operations of `new_workload` before
+// the first iteration and frees them after the last one; the benchmark loop
+// starts and ends on a barrier of all threads.
+template <class Guarded, class Container, class NewWorkload, class... Args>
+static void RunContended(benchmark::State &state, NewWorkload &&new_workload,
+                         Args... args)
+{
+  static Guarded *guarded;
+  static decltype(new_workload()) workload;
+  if (state.thread_index == 0) {
+    workload = new_workload();
+    guarded = new Guarded(args...);
+    for (auto key : workload->Resident()) {
+      guarded->Write(key, [=](Container &c) { c.Insert(key); });
+    }
+  }
+
+  auto i = static_cast<size_t>(state.thread_index) * kOpsPerRun /
+           static_cast<size_t>(state.threads);
+  for (auto _ : state) {
+    const MixedOp op = workload->begin()[i];
+    i = i + 1 == kOpsPerRun ? 0 : i + 1;
+    switch (op.op) {
+    case MapOp::kGet:
+      benchmark::DoNotOptimize(
+          guarded->Read(op.key, [=](Container &c) { return c.Find(op.key); }));
+      break;
+    case MapOp::kInsert:
+      guarded->Write(op.key, [=](Container &c) { c.Insert(op.key); });
+      break;
+    case MapOp::kErase:
+      guarded->Write(op.key, [=](Container &c) { c.Erase(op.key); });
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index == 0) {
+    delete guarded;
+    delete workload;
+  }
+}
+
+// Maps run gets, inserts and erases weighted by the last three args.
+template <template <class> class Guard, class Map, class... Args>
+static void RunContendedMap(benchmark::State &state, Args... args)
+{
+  RunContended<Guard<Map>, Map>(
+      state,
+      [&] {
+        return new MixedWorkload(static_cast<size_t>(state.range(0)),
+                                 kOpsPerRun, state.range(1), state.range(2),
+                                 state.range(3));
+      },
+      args...);
+}
+
+// Deques run front reads, pushes to the back and pops from the front in
+// place of gets, inserts and erases. Every push is paired with a pop that is
+// given the key of the push, so a sharded deque pops from the shard it pushed
+// to, and every deque keeps the size it was filled to.
+template <class Deque>
+class DequeOps
+{
+ public:
+  template <class... Args>
+  explicit DequeOps(Args... args) : _deque(args...)
+  {
+  }
+
+  int Find(int /* key */) { return _deque.Front(); }
+  void Insert(int key) { _deque.PushBack(key); }
+  void Erase(int /* key */) { _deque.PopFront(); }
+
+ private:
+  Deque _deque;
+};
+
+template <template <class> class Guard, class Deque, class... Args>
+static void RunContendedDeque(benchmark::State &state, Args... args)
+{
+  RunContended<Guard<DequeOps<Deque>>, DequeOps<Deque>>(
+      state,
+      [&] {
+        return new DequeWorkload(static_cast<size_t>(state.range(0)),
+                                 kOpsPerRun, state.range(1), state.range(2));
+      },
+      args...);
+}
+
+// Args are the resident size and weights of gets, inserts and erases.
+#define CONTENDED_MAP(benchmark)                    \
+  benchmark->Args({1 << 16, 90, 8, 2})              \
+      ->Args({1 << 16, 50, 25, 25})                 \
+      ->ArgNames({"", "get", "insert", "erase"})    \
+      ->ThreadRange(1, GetMaxThreads())             \
+      ->UseRealTime()
+
+// Args are the resident size and weights of reads and pushes; there are as
+// many pops as pushes.
+#define CONTENDED_DEQUE(benchmark)                  \
+  benchmark->Args({1 << 16, 90, 5})                 \
+      ->Args({1 << 16, 10, 45})                     \
+      ->ArgNames({"", "read", "push"})              \
+      ->ThreadRange(1, GetMaxThreads())             \
+      ->UseRealTime()
+
+// Global mutex map benchmarks:
+template <class Container>
+static void BM_MutexMap_Cpp(benchmark::State &state)
+{
+  RunContendedMap<MutexGuarded, CppMap<Container>>(state);
+}
+CONTENDED_MAP(BENCHMARK_TEMPLATE(BM_MutexMap_Cpp, std::map<int, void *>));
+CONTENDED_MAP(
+    BENCHMARK_TEMPLATE(BM_MutexMap_Cpp, std::unordered_map<int, void *>));
+
+static void BM_MutexMap_CcHashTable(benchmark::State &state)
+{
+  RunContendedMap<MutexGuarded, CcHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_MutexMap_CcHashTable));
+
+static void BM_MutexMap_CcTreeTable(benchmark::State &state)
+{
+  RunContendedMap<MutexGuarded, CcTreeTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_MutexMap_CcTreeTable));
+
+static void BM_MutexMap_GTree(benchmark::State &state)
+{
+  RunContendedMap<MutexGuarded, GTreeMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_MutexMap_GTree));
+
+static void BM_MutexMap_GHashTable(benchmark::State &state)
+{
+  RunContendedMap<MutexGuarded, GHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_MutexMap_GHashTable));
+
+static void BM_MutexMap_CdcMap(benchmark::State &state,
+                               const struct cdc_map_table *table)
+{
+  RunContendedMap<MutexGuarded, CdcMap>(state, table);
+}
+CONTENDED_MAP(
+    BENCHMARK_CAPTURE(BM_MutexMap_CdcMap, hash_table, cdc_map_htable));
+CONTENDED_MAP(BENCHMARK_CAPTURE(BM_MutexMap_CdcMap, avl_tree, cdc_map_avl));
+CONTENDED_MAP(BENCHMARK_CAPTURE(BM_MutexMap_CdcMap, treep, cdc_map_treap));
+CONTENDED_MAP(BENCHMARK_CAPTURE(BM_MutexMap_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_MutexMap_CdcHashTable(benchmark::State &state)
+{
+  RunContendedMap<MutexGuarded, CdcHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_MutexMap_CdcHashTable));
+
+static void BM_MutexMap_CdcAvlTree(benchmark::State &state)
+{
+  RunContendedMap<MutexGuarded, CdcAvlTreeMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_MutexMap_CdcAvlTree));
+
+// Reader-writer lock map benchmarks:
+template <class Container>
+static void BM_RwLockMap_Cpp(benchmark::State &state)
+{
+  RunContendedMap<RwLockGuarded, CppMap<Container>>(state);
+}
+CONTENDED_MAP(BENCHMARK_TEMPLATE(BM_RwLockMap_Cpp, std::map<int, void *>));
+CONTENDED_MAP(
+    BENCHMARK_TEMPLATE(BM_RwLockMap_Cpp, std::unordered_map<int, void *>));
+
+static void BM_RwLockMap_CcHashTable(benchmark::State &state)
+{
+  RunContendedMap<RwLockGuarded, CcHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_RwLockMap_CcHashTable));
+
+static void BM_RwLockMap_CcTreeTable(benchmark::State &state)
+{
+  RunContendedMap<RwLockGuarded, CcTreeTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_RwLockMap_CcTreeTable));
+
+static void BM_RwLockMap_GTree(benchmark::State &state)
+{
+  RunContendedMap<RwLockGuarded, GTreeMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_RwLockMap_GTree));
+
+static void BM_RwLockMap_GHashTable(benchmark::State &state)
+{
+  RunContendedMap<RwLockGuarded, GHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_RwLockMap_GHashTable));
+
+static void BM_RwLockMap_CdcMap(benchmark::State &state,
+                                const struct cdc_map_table *table)
+{
+  RunContendedMap<RwLockGuarded, CdcMap>(state, table);
+}
+CONTENDED_MAP(
+    BENCHMARK_CAPTURE(BM_RwLockMap_CdcMap, hash_table, cdc_map_htable));
+CONTENDED_MAP(BENCHMARK_CAPTURE(BM_RwLockMap_CdcMap, avl_tree, cdc_map_avl));
+CONTENDED_MAP(BENCHMARK_CAPTURE(BM_RwLockMap_CdcMap, treep, cdc_map_treap));
+// Splay tree lookups restructure the tree, so they cannot share a lock.
+
+static void BM_RwLockMap_CdcHashTable(benchmark::State &state)
+{
+  RunContendedMap<RwLockGuarded, CdcHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_RwLockMap_CdcHashTable));
+
+static void BM_RwLockMap_CdcAvlTree(benchmark::State &state)
+{
+  RunContendedMap<RwLockGuarded, CdcAvlTreeMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_RwLockMap_CdcAvlTree));
+
+// Sharded map benchmarks:
+template <class Container>
+static void BM_ShardedMap_Cpp(benchmark::State &state)
+{
+  RunContendedMap<ShardedGuarded, CppMap<Container>>(state);
+}
+CONTENDED_MAP(BENCHMARK_TEMPLATE(BM_ShardedMap_Cpp, std::map<int, void *>));
+CONTENDED_MAP(
+    BENCHMARK_TEMPLATE(BM_ShardedMap_Cpp, std::unordered_map<int, void *>));
+
+static void BM_ShardedMap_CcHashTable(benchmark::State &state)
+{
+  RunContendedMap<ShardedGuarded, CcHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_ShardedMap_CcHashTable));
+
+static void BM_ShardedMap_CcTreeTable(benchmark::State &state)
+{
+  RunContendedMap<ShardedGuarded, CcTreeTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_ShardedMap_CcTreeTable));
+
+static void BM_ShardedMap_GTree(benchmark::State &state)
+{
+  RunContendedMap<ShardedGuarded, GTreeMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_ShardedMap_GTree));
+
+static void BM_ShardedMap_GHashTable(benchmark::State &state)
+{
+  RunContendedMap<ShardedGuarded, GHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_ShardedMap_GHashTable));
+
+static void BM_ShardedMap_CdcMap(benchmark::State &state,
+                                 const struct cdc_map_table *table)
+{
+  RunContendedMap<ShardedGuarded, CdcMap>(state, table);
+}
+CONTENDED_MAP(
+    BENCHMARK_CAPTURE(BM_ShardedMap_CdcMap, hash_table, cdc_map_htable));
+CONTENDED_MAP(BENCHMARK_CAPTURE(BM_ShardedMap_CdcMap, avl_tree, cdc_map_avl));
+CONTENDED_MAP(BENCHMARK_CAPTURE(BM_ShardedMap_CdcMap, treep, cdc_map_treap));
+CONTENDED_MAP(
+    BENCHMARK_CAPTURE(BM_ShardedMap_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_ShardedMap_CdcHashTable(benchmark::State &state)
+{
+  RunContendedMap<ShardedGuarded, CdcHashTableMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_ShardedMap_CdcHashTable));
+
+static void BM_ShardedMap_CdcAvlTree(benchmark::State &state)
+{
+  RunContendedMap<ShardedGuarded, CdcAvlTreeMap>(state);
+}
+CONTENDED_MAP(BENCHMARK(BM_ShardedMap_CdcAvlTree));
+
+// Global mutex deque benchmarks:
+static void BM_MutexDeque_CppDeque(benchmark::State &state)
+{
+  RunContendedDeque<MutexGuarded, CppDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_MutexDeque_CppDeque));
+
+static void BM_MutexDeque_CcDeque(benchmark::State &state)
+{
+  RunContendedDeque<MutexGuarded, CcDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_MutexDeque_CcDeque));
+
+static void BM_MutexDeque_GQueue(benchmark::State &state)
+{
+  RunContendedDeque<MutexGuarded, GQueueDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_MutexDeque_GQueue));
+
+static void BM_MutexDeque_CdcDeque(benchmark::State &state,
+                                   const struct cdc_sequence_table *table)
+{
+  RunContendedDeque<MutexGuarded, CdcDeque>(state, table);
+}
+CONTENDED_DEQUE(
+    BENCHMARK_CAPTURE(BM_MutexDeque_CdcDeque, circular_array, cdc_seq_carray));
+CONTENDED_DEQUE(BENCHMARK_CAPTURE(BM_MutexDeque_CdcDeque, list, cdc_seq_list));
+
+static void BM_MutexDeque_CdcCircularArray(benchmark::State &state)
+{
+  RunContendedDeque<MutexGuarded, CdcCircularArrayDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_MutexDeque_CdcCircularArray));
+
+// Reader-writer lock deque benchmarks:
+static void BM_RwLockDeque_CppDeque(benchmark::State &state)
+{
+  RunContendedDeque<RwLockGuarded, CppDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_RwLockDeque_CppDeque));
+
+static void BM_RwLockDeque_CcDeque(benchmark::State &state)
+{
+  RunContendedDeque<RwLockGuarded, CcDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_RwLockDeque_CcDeque));
+
+static void BM_RwLockDeque_GQueue(benchmark::State &state)
+{
+  RunContendedDeque<RwLockGuarded, GQueueDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_RwLockDeque_GQueue));
+
+static void BM_RwLockDeque_CdcDeque(benchmark::State &state,
+                                    const struct cdc_sequence_table *table)
+{
+  RunContendedDeque<RwLockGuarded, CdcDeque>(state, table);
+}
+CONTENDED_DEQUE(
+    BENCHMARK_CAPTURE(BM_RwLockDeque_CdcDeque, circular_array, cdc_seq_carray));
+CONTENDED_DEQUE(BENCHMARK_CAPTURE(BM_RwLockDeque_CdcDeque, list, cdc_seq_list));
+
+static void BM_RwLockDeque_CdcCircularArray(benchmark::State &state)
+{
+  RunContendedDeque<RwLockGuarded, CdcCircularArrayDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_RwLockDeque_CdcCircularArray));
+
+// Sharded deque benchmarks:
+static void BM_ShardedDeque_CppDeque(benchmark::State &state)
+{
+  RunContendedDeque<ShardedGuarded, CppDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_ShardedDeque_CppDeque));
+
+static void BM_ShardedDeque_CcDeque(benchmark::State &state)
+{
+  RunContendedDeque<ShardedGuarded, CcDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_ShardedDeque_CcDeque));
+
+static void BM_ShardedDeque_GQueue(benchmark::State &state)
+{
+  RunContendedDeque<ShardedGuarded, GQueueDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_ShardedDeque_GQueue));
+
+static void BM_ShardedDeque_CdcDeque(benchmark::State &state,
+                                     const struct cdc_sequence_table *table)
+{
+  RunContendedDeque<ShardedGuarded, CdcDeque>(state, table);
+}
+CONTENDED_DEQUE(BENCHMARK_CAPTURE(BM_ShardedDeque_CdcDeque, circular_array,
+                                  cdc_seq_carray));
+CONTENDED_DEQUE(
+    BENCHMARK_CAPTURE(BM_ShardedDeque_CdcDeque, list, cdc_seq_list));
+
+static void BM_ShardedDeque_CdcCircularArray(benchmark::State &state)
+{
+  RunContendedDeque<ShardedGuarded, CdcCircularArrayDeque>(state);
+}
+CONTENDED_DEQUE(BENCHMARK(BM_ShardedDeque_CdcCircularArray));
+
+BENCH_MAIN();
@@ -26,316 +26,992 @@ extern "C" {
 
 #include <benchmark/benchmark.h>
 
+#include "benchmarks/latency.hpp"
 #include "benchmarks/utils.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <iterator>
 
 // Push back benchmarks:
 static void BM_PushBack_CppDeque(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto deque = new std::deque<int>();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      deque->push_back(GetRandom());
-    }
-
-    state.PauseTiming();
-    delete deque;
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return new std::deque<int>(); },
+      [&](auto deque) {
+        for (auto key : keys) {
+          deque->push_back(key);
+        }
+      },
+      [](auto deque) { delete deque; });
 }
 S(BENCHMARK(BM_PushBack_CppDeque));
 
 static void BM_PushBack_CcDeque(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    Deque *deque = nullptr;
-    deque_new(&deque);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      deque_add_last(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    deque_destroy(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+        }
+      },
+      deque_destroy);
 }
 S(BENCHMARK(BM_PushBack_CcDeque));
 
 static void BM_PushBack_GQueue(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GQueue *deque = g_queue_new();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      g_queue_push_tail(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    g_queue_free(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, g_queue_new,
+      [&](auto deque) {
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+        }
+      },
+      g_queue_free);
 }
 S(BENCHMARK(BM_PushBack_GQueue));
 
 static void BM_PushBack_CdcDeque(benchmark::State &state,
                                  const struct cdc_sequence_table *table)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_deque *deque = nullptr;
-    cdc_deque_ctor(table, &deque, nullptr);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_deque_push_back(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    cdc_deque_dtor(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [=] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+        }
+      },
+      cdc_deque_dtor);
 }
 S(BENCHMARK_CAPTURE(BM_PushBack_CdcDeque, circular_array, cdc_seq_carray));
 S(BENCHMARK_CAPTURE(BM_PushBack_CdcDeque, list, cdc_seq_list));
 
 static void BM_PushBack_CdcCircularArray(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_circular_array *deque = nullptr;
-    cdc_circular_array_ctor(&deque, nullptr);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_circular_array_push_back(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    cdc_circular_array_dtor(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+        }
+      },
+      cdc_circular_array_dtor);
 }
 S(BENCHMARK(BM_PushBack_CdcCircularArray));
 
 // Push front benchmarks:
 static void BM_PushFront_CppDeque(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto deque = new std::deque<int>();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      deque->push_front(GetRandom());
-    }
-
-    state.PauseTiming();
-    delete deque;
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return new std::deque<int>(); },
+      [&](auto deque) {
+        for (auto key : keys) {
+          deque->push_front(key);
+        }
+      },
+      [](auto deque) { delete deque; });
 }
 S(BENCHMARK(BM_PushFront_CppDeque));
 
 static void BM_PushFront_CcDeque(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    Deque *deque = nullptr;
-    deque_new(&deque);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      deque_add_first(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    deque_destroy(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          deque_add_first(deque, CDC_FROM_INT(key));
+        }
+      },
+      deque_destroy);
 }
 S(BENCHMARK(BM_PushFront_CcDeque));
 
 static void BM_PushFront_GQueue(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GQueue *deque = g_queue_new();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      g_queue_push_head(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    g_queue_free(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, g_queue_new,
+      [&](auto deque) {
+        for (auto key : keys) {
+          g_queue_push_head(deque, CDC_FROM_INT(key));
+        }
+      },
+      g_queue_free);
 }
 S(BENCHMARK(BM_PushFront_GQueue));
 
 static void BM_PushFront_CdcDeque(benchmark::State &state,
                                   const struct cdc_sequence_table *table)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_deque *deque = nullptr;
-    cdc_deque_ctor(table, &deque, nullptr);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_deque_push_front(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    cdc_deque_dtor(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [=] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_deque_push_front(deque, CDC_FROM_INT(key));
+        }
+      },
+      cdc_deque_dtor);
 }
 S(BENCHMARK_CAPTURE(BM_PushFront_CdcDeque, circular_array, cdc_seq_carray));
 S(BENCHMARK_CAPTURE(BM_PushFront_CdcDeque, list, cdc_seq_list));
 
 static void BM_PushFront_CdcCircularArray(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_circular_array *deque = nullptr;
-    cdc_circular_array_ctor(&deque, nullptr);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_circular_array_push_front(deque, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    cdc_circular_array_dtor(deque);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_circular_array_push_front(deque, CDC_FROM_INT(key));
+        }
+      },
+      cdc_circular_array_dtor);
 }
 S(BENCHMARK(BM_PushFront_CdcCircularArray));
 
 // Insert rand pos benchmarks:
 static void BM_InsertRandPos_CppDeque(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto deque = new std::deque<int>{1, 2, 3, 4, 5};
-    state.ResumeTiming();
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions =
+      RandomPositions(static_cast<size_t>(state.range(0)), 5);
+  RunBatched(
+      state, [] { return new std::deque<int>{1, 2, 3, 4, 5}; },
+      [&](auto deque) {
+        for (int j = 0; j < state.range(0); ++j) {
+          auto it = std::begin(*deque);
+          std::advance(it, positions[j]);
+          deque->insert(it, keys[j]);
+        }
+      },
+      [](auto deque) { delete deque; });
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_CppDeque));
 
-    for (int j = 0; j < state.range(0); ++j) {
-      auto it = std::begin(*deque);
-      std::advance(it, GetRandomPos(deque->size()));
-      deque->insert(it, GetRandom());
-    }
+static void BM_InsertRandPos_CcDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions =
+      RandomPositions(static_cast<size_t>(state.range(0)), 5);
+  RunBatched(
+      state,
+      [] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        for (int i = 1; i < 6; ++i) {
+          deque_add_last(deque, CDC_FROM_INT(i));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (int j = 0; j < state.range(0); ++j) {
+          deque_add_at(deque, CDC_FROM_INT(keys[j]), positions[j]);
+        }
+      },
+      deque_destroy);
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_CcDeque));
 
-    state.PauseTiming();
-    delete deque;
-    state.ResumeTiming();
-  }
+static void BM_InsertRandPos_GQueue(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions =
+      RandomPositions(static_cast<size_t>(state.range(0)), 5);
+  RunBatched(
+      state,
+      [] {
+        GQueue *deque = g_queue_new();
+        for (int i = 1; i < 6; ++i) {
+          g_queue_push_head(deque, CDC_FROM_INT(i));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (int j = 0; j < state.range(0); ++j) {
+          g_queue_push_nth(deque, CDC_FROM_INT(keys[j]),
+                           static_cast<int>(positions[j]));
+        }
+      },
+      g_queue_free);
 }
-S(BENCHMARK(BM_InsertRandPos_CppDeque));
+S_SMALL(BENCHMARK(BM_InsertRandPos_GQueue));
 
-static void BM_InsertRandPos_CcDeque(benchmark::State &state)
+static void BM_InsertRandPos_CdcDeque(benchmark::State &state,
+                                      const struct cdc_sequence_table *table)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions =
+      RandomPositions(static_cast<size_t>(state.range(0)), 5);
+  RunBatched(
+      state,
+      [=] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctorl(table, &deque, nullptr, CDC_FROM_INT(1),
+                        CDC_FROM_INT(2), CDC_FROM_INT(3), CDC_FROM_INT(4),
+                        CDC_FROM_INT(5), CDC_END);
+        return deque;
+      },
+      [&](auto deque) {
+        for (int j = 0; j < state.range(0); ++j) {
+          cdc_deque_insert(deque, positions[j], CDC_FROM_INT(keys[j]));
+        }
+      },
+      cdc_deque_dtor);
+}
+S_SMALL(BENCHMARK_CAPTURE(BM_InsertRandPos_CdcDeque, circular_array,
+                          cdc_seq_carray));
+S_SMALL(BENCHMARK_CAPTURE(BM_InsertRandPos_CdcDeque, list, cdc_seq_list));
+
+static void BM_InsertRandPos_CdcCircularArray(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    Deque *deque = nullptr;
-    deque_new(&deque);
-    for (int i = 1; i < 6; ++i) {
-      deque_add_last(deque, CDC_FROM_INT(i));
-    }
-    state.ResumeTiming();
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions =
+      RandomPositions(static_cast<size_t>(state.range(0)), 5);
+  RunBatched(
+      state,
+      [] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctorl(&deque, nullptr, CDC_FROM_INT(1),
+                                 CDC_FROM_INT(2), CDC_FROM_INT(3),
+                                 CDC_FROM_INT(4), CDC_FROM_INT(5), CDC_END);
+        return deque;
+      },
+      [&](auto deque) {
+        for (int j = 0; j < state.range(0); ++j) {
+          cdc_circular_array_insert(deque, positions[j],
+                                    CDC_FROM_INT(keys[j]));
+        }
+      },
+      cdc_circular_array_dtor);
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_CdcCircularArray));
 
-    for (int j = 0; j < state.range(0); ++j) {
-      deque_add_at(deque, CDC_FROM_INT(GetRandom()),
-                   GetRandomPos(deque_size(deque)));
-    }
+// Random get benchmarks:
+// Deques of N elements read N elements at random positions. GQueue and the
+// list deque walk to the position, so they only run the default sizes.
+static void BM_RandomGet_CppDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunBatched(
+      state,
+      [&] { return new std::deque<int>(std::cbegin(keys), std::cend(keys)); },
+      [&](auto deque) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize((*deque)[i]);
+        }
+      },
+      [](auto deque) { delete deque; });
+}
+S(BENCHMARK(BM_RandomGet_CppDeque));
 
-    state.PauseTiming();
-    deque_destroy(deque);
-    state.ResumeTiming();
-  }
+static void BM_RandomGet_CcDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  void *value = nullptr;
+  RunBatched(
+      state,
+      [&] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto i : indices) {
+          deque_get_at(deque, i, &value);
+          benchmark::DoNotOptimize(value);
+        }
+      },
+      deque_destroy);
 }
-S(BENCHMARK(BM_InsertRandPos_CcDeque));
+S(BENCHMARK(BM_RandomGet_CcDeque));
 
-static void BM_InsertRandPos_GQueue(benchmark::State &state)
+static void BM_RandomGet_GQueue(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GQueue *deque = g_queue_new();
-    for (int i = 1; i < 6; ++i) {
-      g_queue_push_head(deque, CDC_FROM_INT(i));
-    }
-    state.ResumeTiming();
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunBatched(
+      state,
+      [&] {
+        GQueue *deque = g_queue_new();
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize(
+              g_queue_peek_nth(deque, static_cast<guint>(i)));
+        }
+      },
+      g_queue_free);
+}
+S_SMALL(BENCHMARK(BM_RandomGet_GQueue));
 
-    for (int j = 0; j < state.range(0); ++j) {
-      g_queue_push_nth(
-          deque, CDC_FROM_INT(GetRandom()),
-          static_cast<int>(GetRandomPos(g_queue_get_length(deque))));
-    }
+static void BM_RandomGet_CdcDeque(benchmark::State &state,
+                                  const struct cdc_sequence_table *table)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize(cdc_deque_get(deque, i));
+        }
+      },
+      cdc_deque_dtor);
+}
+S(BENCHMARK_CAPTURE(BM_RandomGet_CdcDeque, circular_array, cdc_seq_carray));
+S_SMALL(BENCHMARK_CAPTURE(BM_RandomGet_CdcDeque, list, cdc_seq_list));
 
-    state.PauseTiming();
-    g_queue_free(deque);
-    state.ResumeTiming();
-  }
+static void BM_RandomGet_CdcCircularArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize(cdc_circular_array_get(deque, i));
+        }
+      },
+      cdc_circular_array_dtor);
 }
-S(BENCHMARK(BM_InsertRandPos_GQueue));
+S(BENCHMARK(BM_RandomGet_CdcCircularArray));
 
-static void BM_InsertRandPos_CdcDeque(benchmark::State &state,
+// Erase rand pos benchmarks:
+// Deques of N elements are emptied by erasing at random positions. The
+// positions of inserts into an empty deque, taken in reverse, are valid
+// positions of erases down to an empty deque.
+static void BM_EraseRandPos_CppDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state,
+      [&] { return new std::deque<int>(std::cbegin(keys), std::cend(keys)); },
+      [&](auto deque) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) {
+                        auto it = std::begin(*deque);
+                        std::advance(it, pos);
+                        deque->erase(it);
+                      });
+      },
+      [](auto deque) { delete deque; });
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_CppDeque));
+
+static void BM_EraseRandPos_CcDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state,
+      [&] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) { deque_remove_at(deque, pos, nullptr); });
+      },
+      deque_destroy);
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_CcDeque));
+
+static void BM_EraseRandPos_GQueue(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state,
+      [&] {
+        GQueue *deque = g_queue_new();
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) {
+                        g_queue_pop_nth(deque, static_cast<guint>(pos));
+                      });
+      },
+      g_queue_free);
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_GQueue));
+
+static void BM_EraseRandPos_CdcDeque(benchmark::State &state,
+                                     const struct cdc_sequence_table *table)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) { cdc_deque_erase(deque, pos); });
+      },
+      cdc_deque_dtor);
+}
+S_SMALL(BENCHMARK_CAPTURE(BM_EraseRandPos_CdcDeque, circular_array,
+                          cdc_seq_carray));
+S_SMALL(BENCHMARK_CAPTURE(BM_EraseRandPos_CdcDeque, list, cdc_seq_list));
+
+static void BM_EraseRandPos_CdcCircularArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        std::for_each(
+            std::crbegin(positions), std::crend(positions),
+            [=](auto pos) { cdc_circular_array_erase(deque, pos); });
+      },
+      cdc_circular_array_dtor);
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_CdcCircularArray));
+
+// Insert and erase at benchmarks:
+// Deques of N elements insert a key and erase it again N times at one
+// position: `at` percent of the size, near the front (1), in the middle (50)
+// or near the back (99). Every insert and erase may move or walk O(N)
+// elements, so they keep the default sizes.
+static void InsertEraseAtArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSmallSizes(benchmark, {1, 50, 99});
+}
+
+#define INSERT_ERASE_AT(benchmark) \
+  benchmark->Apply(InsertEraseAtArgs)->ArgNames({"", "at"})->UseManualTime()
+
+static size_t InsertErasePosition(const benchmark::State &state)
+{
+  return static_cast<size_t>(state.range(0) * state.range(1) / 100);
+}
+
+static void BM_InsertEraseAt_CppDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const size_t pos = InsertErasePosition(state);
+  RunBatched(
+      state,
+      [&] { return new std::deque<int>(std::cbegin(keys), std::cend(keys)); },
+      [&](auto deque) {
+        for (auto key : keys) {
+          auto it = deque->insert(std::begin(*deque) + pos, key);
+          deque->erase(it);
+        }
+      },
+      [](auto deque) { delete deque; });
+}
+INSERT_ERASE_AT(BENCHMARK(BM_InsertEraseAt_CppDeque));
+
+static void BM_InsertEraseAt_CcDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const size_t pos = InsertErasePosition(state);
+  RunBatched(
+      state,
+      [&] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          deque_add_at(deque, CDC_FROM_INT(key), pos);
+          deque_remove_at(deque, pos, nullptr);
+        }
+      },
+      deque_destroy);
+}
+INSERT_ERASE_AT(BENCHMARK(BM_InsertEraseAt_CcDeque));
+
+static void BM_InsertEraseAt_GQueue(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto pos = static_cast<guint>(InsertErasePosition(state));
+  RunBatched(
+      state,
+      [&] {
+        GQueue *deque = g_queue_new();
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          g_queue_push_nth(deque, CDC_FROM_INT(key), static_cast<gint>(pos));
+          g_queue_pop_nth(deque, pos);
+        }
+      },
+      g_queue_free);
+}
+INSERT_ERASE_AT(BENCHMARK(BM_InsertEraseAt_GQueue));
+
+static void BM_InsertEraseAt_CdcDeque(benchmark::State &state,
                                       const struct cdc_sequence_table *table)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_deque *deque = nullptr;
-    cdc_deque_ctorl(table, &deque, nullptr, CDC_FROM_INT(1), CDC_FROM_INT(2),
-                    CDC_FROM_INT(3), CDC_FROM_INT(4), CDC_FROM_INT(5), CDC_END);
-    state.ResumeTiming();
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const size_t pos = InsertErasePosition(state);
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_deque_insert(deque, pos, CDC_FROM_INT(key));
+          cdc_deque_erase(deque, pos);
+        }
+      },
+      cdc_deque_dtor);
+}
+INSERT_ERASE_AT(BENCHMARK_CAPTURE(BM_InsertEraseAt_CdcDeque, circular_array,
+                                  cdc_seq_carray));
+INSERT_ERASE_AT(BENCHMARK_CAPTURE(BM_InsertEraseAt_CdcDeque, list,
+                                  cdc_seq_list));
+
+static void BM_InsertEraseAt_CdcCircularArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const size_t pos = InsertErasePosition(state);
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_circular_array_insert(deque, pos, CDC_FROM_INT(key));
+          cdc_circular_array_erase(deque, pos);
+        }
+      },
+      cdc_circular_array_dtor);
+}
+INSERT_ERASE_AT(BENCHMARK(BM_InsertEraseAt_CdcCircularArray));
+
+// Steady-state FIFO benchmarks:
+// Deques of N elements push N keys at the back and pop N at the front per
+// iteration, a full turn that keeps their size. Deques are built once and
+// turned for every batch, so circular buffers keep wrapping around and
+// std::deque keeps recycling its blocks instead of growing.
+static void BM_Fifo_CppDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] { return new std::deque<int>(std::cbegin(keys), std::cend(keys)); },
+      [&](auto deque) {
+        for (auto key : keys) {
+          deque->push_back(key);
+          deque->pop_front();
+        }
+      },
+      [](auto deque) { delete deque; });
+}
+S(BENCHMARK(BM_Fifo_CppDeque));
 
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_deque_insert(deque, GetRandomPos(cdc_deque_size(deque)),
-                       CDC_FROM_INT(GetRandom()));
-    }
+static void BM_Fifo_CcDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+          deque_remove_first(deque, nullptr);
+        }
+      },
+      deque_destroy);
+}
+S(BENCHMARK(BM_Fifo_CcDeque));
 
-    state.PauseTiming();
-    cdc_deque_dtor(deque);
-    deque = nullptr;
-    state.ResumeTiming();
-  }
+static void BM_Fifo_GQueue(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        GQueue *deque = g_queue_new();
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+          g_queue_pop_head(deque);
+        }
+      },
+      g_queue_free);
 }
-S(BENCHMARK_CAPTURE(BM_InsertRandPos_CdcDeque, circular_array, cdc_seq_carray));
-S(BENCHMARK_CAPTURE(BM_InsertRandPos_CdcDeque, list, cdc_seq_list));
+S(BENCHMARK(BM_Fifo_GQueue));
 
-static void BM_InsertRandPos_CdcCircularArray(benchmark::State &state)
+static void BM_Fifo_CdcDeque(benchmark::State &state,
+                             const struct cdc_sequence_table *table)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+          cdc_deque_pop_front(deque);
+        }
+      },
+      cdc_deque_dtor);
+}
+S(BENCHMARK_CAPTURE(BM_Fifo_CdcDeque, circular_array, cdc_seq_carray));
+S(BENCHMARK_CAPTURE(BM_Fifo_CdcDeque, list, cdc_seq_list));
+
+static void BM_Fifo_CdcCircularArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+          cdc_circular_array_pop_front(deque);
+        }
+      },
+      cdc_circular_array_dtor);
+}
+S(BENCHMARK(BM_Fifo_CdcCircularArray));
+
+// Sliding window benchmarks:
+// The FIFO turn of a window of N keys that keeps the sum of the window: every
+// step reads the key leaving the window at the front before it is popped.
+static void BM_SlidingWindow_CppDeque(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_circular_array *deque = nullptr;
-    cdc_circular_array_ctorl(&deque, nullptr, CDC_FROM_INT(1), CDC_FROM_INT(2),
-                             CDC_FROM_INT(3), CDC_FROM_INT(4), CDC_FROM_INT(5),
-                             CDC_END);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_circular_array_insert(deque,
-                                GetRandomPos(cdc_circular_array_size(deque)),
-                                CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    cdc_circular_array_dtor(deque);
-    deque = nullptr;
-    state.ResumeTiming();
-  }
-}
-S(BENCHMARK(BM_InsertRandPos_CdcCircularArray));
-
-BENCHMARK_MAIN();
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] { return new std::deque<int>(std::cbegin(keys), std::cend(keys)); },
+      [&](auto deque) {
+        int64_t sum = 0;
+        for (auto key : keys) {
+          deque->push_back(key);
+          sum += key - deque->front();
+          deque->pop_front();
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      [](auto deque) { delete deque; });
+}
+S(BENCHMARK(BM_SlidingWindow_CppDeque));
+
+static void BM_SlidingWindow_CcDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        int64_t sum = 0;
+        void *front = nullptr;
+        for (auto key : keys) {
+          deque_add_last(deque, CDC_FROM_INT(key));
+          deque_remove_first(deque, &front);
+          sum += key - CDC_TO_INT(front);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      deque_destroy);
+}
+S(BENCHMARK(BM_SlidingWindow_CcDeque));
+
+static void BM_SlidingWindow_GQueue(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        GQueue *deque = g_queue_new();
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        int64_t sum = 0;
+        for (auto key : keys) {
+          g_queue_push_tail(deque, CDC_FROM_INT(key));
+          sum += key - CDC_TO_INT(g_queue_pop_head(deque));
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      g_queue_free);
+}
+S(BENCHMARK(BM_SlidingWindow_GQueue));
+
+static void BM_SlidingWindow_CdcDeque(benchmark::State &state,
+                                      const struct cdc_sequence_table *table)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        int64_t sum = 0;
+        for (auto key : keys) {
+          cdc_deque_push_back(deque, CDC_FROM_INT(key));
+          sum += key - CDC_TO_INT(cdc_deque_front(deque));
+          cdc_deque_pop_front(deque);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      cdc_deque_dtor);
+}
+S(BENCHMARK_CAPTURE(BM_SlidingWindow_CdcDeque, circular_array,
+                    cdc_seq_carray));
+S(BENCHMARK_CAPTURE(BM_SlidingWindow_CdcDeque, list, cdc_seq_list));
+
+static void BM_SlidingWindow_CdcCircularArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state,
+      [&] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+        }
+        return deque;
+      },
+      [&](auto deque) {
+        int64_t sum = 0;
+        for (auto key : keys) {
+          cdc_circular_array_push_back(deque, CDC_FROM_INT(key));
+          sum += key - CDC_TO_INT(cdc_circular_array_front(deque));
+          cdc_circular_array_pop_front(deque);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      cdc_circular_array_dtor);
+}
+S(BENCHMARK(BM_SlidingWindow_CdcCircularArray));
+
+// Push back latency benchmarks:
+// Every push is timed on its own, for the p50, p90, p99, p99.9 and max
+// latency counters: block allocations and reallocations of the arrays show in
+// the tail rather than in the mean.
+static void BM_PushBackLatency_CppDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunSampled(
+      state, [] { return new std::deque<int>(); },
+      [&](auto deque, size_t i) { deque->push_back(keys[i]); },
+      [](auto deque) { delete deque; });
+}
+S_LATENCY(BENCHMARK(BM_PushBackLatency_CppDeque));
+
+static void BM_PushBackLatency_CcDeque(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunSampled(
+      state,
+      [] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        return deque;
+      },
+      [&](auto deque, size_t i) {
+        deque_add_last(deque, CDC_FROM_INT(keys[i]));
+      },
+      deque_destroy);
+}
+S_LATENCY(BENCHMARK(BM_PushBackLatency_CcDeque));
+
+static void BM_PushBackLatency_GQueue(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunSampled(
+      state, g_queue_new,
+      [&](auto deque, size_t i) {
+        g_queue_push_tail(deque, CDC_FROM_INT(keys[i]));
+      },
+      g_queue_free);
+}
+S_LATENCY(BENCHMARK(BM_PushBackLatency_GQueue));
+
+static void BM_PushBackLatency_CdcDeque(benchmark::State &state,
+                                        const struct cdc_sequence_table *table)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunSampled(
+      state,
+      [=] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, nullptr);
+        return deque;
+      },
+      [&](auto deque, size_t i) {
+        cdc_deque_push_back(deque, CDC_FROM_INT(keys[i]));
+      },
+      cdc_deque_dtor);
+}
+S_LATENCY(BENCHMARK_CAPTURE(BM_PushBackLatency_CdcDeque, circular_array,
+                            cdc_seq_carray));
+S_LATENCY(BENCHMARK_CAPTURE(BM_PushBackLatency_CdcDeque, list, cdc_seq_list));
+
+static void BM_PushBackLatency_CdcCircularArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunSampled(
+      state,
+      [] {
+        struct cdc_circular_array *deque = nullptr;
+        cdc_circular_array_ctor(&deque, nullptr);
+        return deque;
+      },
+      [&](auto deque, size_t i) {
+        cdc_circular_array_push_back(deque, CDC_FROM_INT(keys[i]));
+      },
+      cdc_circular_array_dtor);
+}
+S_LATENCY(BENCHMARK(BM_PushBackLatency_CdcCircularArray));
+
+BENCH_MAIN();
@@ -26,255 +26,1085 @@ extern "C" {
 
 #include <benchmark/benchmark.h>
 
+#include "benchmarks/pmr.hpp"
 #include "benchmarks/utils.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <list>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
 
 // Push back benchmarks:
 static void BM_PushBack_CppList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto list = new std::list<int>();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      list->push_back(GetRandom());
-    }
-
-    state.PauseTiming();
-    delete list;
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return new std::list<int>(); },
+      [&](auto list) {
+        for (auto key : keys) {
+          list->push_back(key);
+        }
+      },
+      [](auto list) { delete list; });
 }
 S(BENCHMARK(BM_PushBack_CppList));
 
-static void BM_PushBack_CcList(benchmark::State &state)
+template <class Resource>
+static void BM_PushBack_CppPmrList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    List *list = nullptr;
-    list_new(&list);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      list_add_last(list, CDC_FROM_INT(GetRandom()));
-    }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return new CppPmrList<Resource>(); },
+      [&](auto list) {
+        for (auto key : keys) {
+          list->push_back(key);
+        }
+      },
+      [](auto list) { delete list; });
+}
+S(BENCHMARK_TEMPLATE(BM_PushBack_CppPmrList,
+                     std::pmr::monotonic_buffer_resource));
+S(BENCHMARK_TEMPLATE(BM_PushBack_CppPmrList,
+                     std::pmr::unsynchronized_pool_resource));
 
-    state.PauseTiming();
-    list_destroy(list);
-    state.ResumeTiming();
-  }
+static void BM_PushBack_CcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        List *list = nullptr;
+        list_new(&list);
+        return list;
+      },
+      [&](auto list) {
+        for (auto key : keys) {
+          list_add_last(list, CDC_FROM_INT(key));
+        }
+      },
+      list_destroy);
 }
 S(BENCHMARK(BM_PushBack_CcList));
 
 static void BM_PushBack_GList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GList *list = g_list_alloc();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      list = g_list_append(list, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    g_list_free(list);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, g_list_alloc,
+      [&](auto &list) {
+        for (auto key : keys) {
+          list = g_list_append(list, CDC_FROM_INT(key));
+        }
+      },
+      g_list_free);
 }
-S(BENCHMARK(BM_PushBack_GList));
+S_SMALL(BENCHMARK(BM_PushBack_GList));
 
 static void BM_PushBack_CdcList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_list *list = nullptr;
-    cdc_list_ctor(&list, nullptr);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_list_push_back(list, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    cdc_list_dtor(list);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        struct cdc_list *list = nullptr;
+        cdc_list_ctor(&list, nullptr);
+        return list;
+      },
+      [&](auto list) {
+        for (auto key : keys) {
+          cdc_list_push_back(list, CDC_FROM_INT(key));
+        }
+      },
+      cdc_list_dtor);
 }
 S(BENCHMARK(BM_PushBack_CdcList));
 
 // Push front benchmarks:
 static void BM_PushFront_CppList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto list = new std::list<int>();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      list->push_front(GetRandom());
-    }
-
-    state.PauseTiming();
-    delete list;
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return new std::list<int>(); },
+      [&](auto list) {
+        for (auto key : keys) {
+          list->push_front(key);
+        }
+      },
+      [](auto list) { delete list; });
 }
 S(BENCHMARK(BM_PushFront_CppList));
 
-static void BM_PushFront_CcList(benchmark::State &state)
+template <class Resource>
+static void BM_PushFront_CppPmrList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    List *list = nullptr;
-    list_new(&list);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      list_add_first(list, CDC_FROM_INT(GetRandom()));
-    }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return new CppPmrList<Resource>(); },
+      [&](auto list) {
+        for (auto key : keys) {
+          list->push_front(key);
+        }
+      },
+      [](auto list) { delete list; });
+}
+S(BENCHMARK_TEMPLATE(BM_PushFront_CppPmrList,
+                     std::pmr::monotonic_buffer_resource));
+S(BENCHMARK_TEMPLATE(BM_PushFront_CppPmrList,
+                     std::pmr::unsynchronized_pool_resource));
 
-    state.PauseTiming();
-    list_destroy(list);
-    state.ResumeTiming();
-  }
+static void BM_PushFront_CcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        List *list = nullptr;
+        list_new(&list);
+        return list;
+      },
+      [&](auto list) {
+        for (auto key : keys) {
+          list_add_first(list, CDC_FROM_INT(key));
+        }
+      },
+      list_destroy);
 }
 S(BENCHMARK(BM_PushFront_CcList));
 
 static void BM_PushFront_GList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GList *list = g_list_alloc();
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      list = g_list_prepend(list, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    g_list_free(list);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, g_list_alloc,
+      [&](auto &list) {
+        for (auto key : keys) {
+          list = g_list_prepend(list, CDC_FROM_INT(key));
+        }
+      },
+      g_list_free);
 }
 S(BENCHMARK(BM_PushFront_GList));
 
 static void BM_PushFront_CdcList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_list *list = nullptr;
-    cdc_list_ctor(&list, nullptr);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_list_push_front(list, CDC_FROM_INT(GetRandom()));
-    }
-
-    state.PauseTiming();
-    cdc_list_dtor(list);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        struct cdc_list *list = nullptr;
+        cdc_list_ctor(&list, nullptr);
+        return list;
+      },
+      [&](auto list) {
+        for (auto key : keys) {
+          cdc_list_push_front(list, CDC_FROM_INT(key));
+        }
+      },
+      cdc_list_dtor);
 }
 S(BENCHMARK(BM_PushFront_CdcList));
 
 // Insert mid benchmarks:
 static void BM_InsertMid_CppList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto list = new std::list<int>{1, 2, 3, 4, 5};
-    auto it = std::find(std::cbegin(*list), std::cend(*list), 3);
-    state.ResumeTiming();
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        auto list = new std::list<int>{1, 2, 3, 4, 5};
+        auto it = std::find(std::cbegin(*list), std::cend(*list), 3);
+        return std::make_pair(list, it);
+      },
+      [&](auto &p) {
+        for (auto key : keys) {
+          p.first->insert(p.second, key);
+        }
+      },
+      [](auto &p) { delete p.first; });
+}
+S(BENCHMARK(BM_InsertMid_CppList));
+
+template <class Resource>
+static void BM_InsertMid_CppPmrList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        auto list = new CppPmrList<Resource>{1, 2, 3, 4, 5};
+        auto it = std::find(std::cbegin(*list), std::cend(*list), 3);
+        return std::make_pair(list, it);
+      },
+      [&](auto &p) {
+        for (auto key : keys) {
+          p.first->insert(p.second, key);
+        }
+      },
+      [](auto &p) { delete p.first; });
+}
+S(BENCHMARK_TEMPLATE(BM_InsertMid_CppPmrList,
+                     std::pmr::monotonic_buffer_resource));
+S(BENCHMARK_TEMPLATE(BM_InsertMid_CppPmrList,
+                     std::pmr::unsynchronized_pool_resource));
+
+static void BM_InsertMid_CcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        List *list = nullptr;
+        list_new(&list);
+        for (int i = 1; i < 6; ++i) {
+          list_add_last(list, CDC_FROM_INT(i));
+        }
+        ListIter iter = {};
+        list_iter_init(&iter, list);
+        void *val = nullptr;
+        while (list_iter_next(&iter, &val) != CC_ITER_END &&
+               val != CDC_FROM_INT(3)) {
+          /* empty */;
+        }
+        return std::make_pair(list, iter);
+      },
+      [&](auto &p) {
+        for (auto key : keys) {
+          list_iter_add(&p.second, CDC_FROM_INT(key));
+        }
+      },
+      [](auto &p) { list_destroy(p.first); });
+}
+S(BENCHMARK(BM_InsertMid_CcList));
+
+static void BM_InsertMid_GList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        GList *list = g_list_alloc();
+        for (int i = 1; i < 6; ++i) {
+          list = g_list_append(list, CDC_FROM_INT(i));
+        }
+        GList *it = g_list_find(list, CDC_FROM_INT(3));
+        return std::make_pair(list, it);
+      },
+      [&](auto &p) {
+        for (auto key : keys) {
+          p.first = g_list_insert_before(p.first, p.second, CDC_FROM_INT(key));
+        }
+      },
+      [](auto &p) { g_list_free(p.first); });
+}
+S(BENCHMARK(BM_InsertMid_GList));
+
+static void BM_InsertMid_CdcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        struct cdc_list *list = nullptr;
+        cdc_list_ctorl(&list, nullptr, CDC_FROM_INT(1), CDC_FROM_INT(2),
+                       CDC_FROM_INT(3), CDC_FROM_INT(4), CDC_FROM_INT(5),
+                       CDC_END);
+        struct cdc_list_iter it = {};
+        cdc_list_begin(list, &it);
+        while (cdc_list_iter_has_next(&it) &&
+               cdc_list_iter_data(&it) != CDC_FROM_INT(3)) {
+          cdc_list_iter_next(&it);
+        }
+        return std::make_pair(list, it);
+      },
+      [&](auto &p) {
+        for (auto key : keys) {
+          cdc_list_iinsert(&p.second, CDC_FROM_INT(key));
+        }
+      },
+      [](auto &p) { cdc_list_dtor(p.first); });
+}
+S(BENCHMARK(BM_InsertMid_CdcList));
+
+// List algorithm benchmarks:
+// Lists are built before the clock starts; the timed region runs one
+// algorithm over the whole list. The algorithms run from 1 << 4 to 1 << 22
+// elements, far out of the LLC, since their cost there is all pointer
+// chasing.
+#ifdef BENCH_LARGE_N
+#define S_ALGO(benchmark) S(benchmark)
+#else
+#define S_ALGO(benchmark)                                                \
+  benchmark->RangeMultiplier(4)->Range(1 << 4, 1 << 22)->UseManualTime()
+#endif
 
-    for (int j = 0; j < state.range(0); ++j) {
-      list->insert(it, GetRandom());
+// Adds sizes from 1 << 4 to the largest size of S_ALGO in steps of four, for
+// every value of the second argument.
+static void AddAlgoSizes(benchmark::internal::Benchmark *benchmark,
+                         std::initializer_list<int64_t> params)
+{
+#ifdef BENCH_LARGE_N
+  const int64_t kMaxSize = 1 << 26;
+#else
+  const int64_t kMaxSize = 1 << 22;
+#endif
+  for (auto param : params) {
+    for (int64_t n = 1 << 4; n <= kMaxSize; n *= 4) {
+      benchmark->Args({n, param});
     }
+  }
+}
+
+template <class Keys>
+static std::list<int> *NewCppList(const Keys &keys)
+{
+  return new std::list<int>(std::cbegin(keys), std::cend(keys));
+}
 
-    state.PauseTiming();
-    delete list;
-    state.ResumeTiming();
+template <class Keys>
+static List *NewCcList(const Keys &keys)
+{
+  List *list = nullptr;
+  list_new(&list);
+  for (auto key : keys) {
+    list_add_last(list, CDC_FROM_INT(key));
   }
+  return list;
 }
-S(BENCHMARK(BM_InsertMid_CppList));
 
-static void BM_InsertMid_CcList(benchmark::State &state)
+// g_list_append() walks to the last node, so the list is built backwards.
+template <class Keys>
+static GList *NewGList(const Keys &keys)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    List *list = nullptr;
-    list_new(&list);
-    for (int i = 1; i < 6; ++i) {
-      list_add_last(list, CDC_FROM_INT(i));
-    }
-    ListIter iter = {};
-    list_iter_init(&iter, list);
-    void *val = nullptr;
-    while (list_iter_next(&iter, &val) != CC_ITER_END &&
-           val != CDC_FROM_INT(3)) {
-      /* empty */;
-    }
-    state.ResumeTiming();
+  GList *list = nullptr;
+  for (auto key : keys) {
+    list = g_list_prepend(list, CDC_FROM_INT(key));
+  }
+  return g_list_reverse(list);
+}
 
-    for (int j = 0; j < state.range(0); ++j) {
-      list_iter_add(&iter, CDC_FROM_INT(GetRandom()));
-    }
+template <class Keys>
+static struct cdc_list *NewCdcList(const Keys &keys,
+                                   struct cdc_data_info *info = nullptr)
+{
+  struct cdc_list *list = nullptr;
+  cdc_list_ctor(&list, info);
+  for (auto key : keys) {
+    cdc_list_push_back(list, CDC_FROM_INT(key));
+  }
+  return list;
+}
+
+static int IsOdd(const void *value) { return CDC_TO_INT(value) % 2 != 0; }
+
+static bool IsEven(const void *value) { return CDC_TO_INT(value) % 2 == 0; }
 
-    state.PauseTiming();
-    list_destroy(list);
-    state.ResumeTiming();
+// Sort benchmarks:
+static void BM_Sort_CppList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCppList(keys); },
+      [](auto list) { list->sort(); }, [](auto list) { delete list; });
+}
+S_ALGO(BENCHMARK(BM_Sort_CppList));
+
+static void BM_Sort_CcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCcList(keys); },
+      [](auto list) { list_sort_in_place(list, CcElementCmp); }, list_destroy);
+}
+S_ALGO(BENCHMARK(BM_Sort_CcList));
+
+static void BM_Sort_GList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewGList(keys); },
+      [](auto &list) { list = g_list_sort(list, CcCmp); }, g_list_free);
+}
+S_ALGO(BENCHMARK(BM_Sort_GList));
+
+static void BM_Sort_CdcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  struct cdc_data_info info = {};
+  info.cmp = Less;
+  RunBatched(
+      state, [&] { return NewCdcList(keys, &info); }, cdc_list_sort,
+      cdc_list_dtor);
+}
+S_ALGO(BENCHMARK(BM_Sort_CdcList));
+
+// Merge benchmarks:
+// Merges the even keys 2, 4, ..., N into the odd keys 1, 3, ..., N - 1, so
+// every step of the merge switches lists. GList and Collections-C List have
+// no merge.
+static std::vector<int> MergeKeys(size_t size, int parity)
+{
+  std::vector<int> keys(size / 2);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = static_cast<int>(2 * i) + parity;
   }
+  return keys;
 }
-S(BENCHMARK(BM_InsertMid_CcList));
 
-static void BM_InsertMid_GList(benchmark::State &state)
+static void BM_Merge_CppList(benchmark::State &state)
+{
+  const auto odd = MergeKeys(static_cast<size_t>(state.range(0)), 1);
+  const auto even = MergeKeys(static_cast<size_t>(state.range(0)), 2);
+  RunBatched(
+      state, [&] { return std::make_pair(NewCppList(odd), NewCppList(even)); },
+      [](auto &p) { p.first->merge(*p.second); },
+      [](auto &p) {
+        delete p.first;
+        delete p.second;
+      });
+}
+S_ALGO(BENCHMARK(BM_Merge_CppList));
+
+static void BM_Merge_CdcList(benchmark::State &state)
+{
+  const auto odd = MergeKeys(static_cast<size_t>(state.range(0)), 1);
+  const auto even = MergeKeys(static_cast<size_t>(state.range(0)), 2);
+  struct cdc_data_info info = {};
+  info.cmp = Less;
+  RunBatched(
+      state,
+      [&] {
+        return std::make_pair(NewCdcList(odd, &info), NewCdcList(even, &info));
+      },
+      [](auto &p) { cdc_list_merge(p.first, p.second); },
+      [](auto &p) {
+        cdc_list_dtor(p.first);
+        cdc_list_dtor(p.second);
+      });
+}
+S_ALGO(BENCHMARK(BM_Merge_CdcList));
+
+// Splice benchmarks:
+// Moves a list of N elements to another list in ranges of `chunk` elements
+// from its front to the back of the other list, so every splice walks its
+// range. Collections-C List only splices whole lists, so it is left out.
+static void SpliceArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddAlgoSizes(benchmark, {1, 64, 4096});
+}
+
+#define SPLICE(benchmark) \
+  benchmark->Apply(SpliceArgs)->ArgNames({"", "chunk"})->UseManualTime()
+
+static void BM_Splice_CppList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto chunk = static_cast<size_t>(state.range(1));
+  RunBatched(
+      state,
+      [&] { return std::make_pair(NewCppList(keys), new std::list<int>()); },
+      [=](auto &p) {
+        for (size_t rest = keys.Size(); rest != 0;) {
+          const size_t count = std::min(chunk, rest);
+          auto first = std::begin(*p.first);
+          p.second->splice(std::end(*p.second), *p.first, first,
+                           std::next(first, static_cast<ptrdiff_t>(count)));
+          rest -= count;
+        }
+      },
+      [](auto &p) {
+        delete p.first;
+        delete p.second;
+      });
+}
+SPLICE(BENCHMARK(BM_Splice_CppList));
+
+static void BM_Splice_GList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto chunk = static_cast<size_t>(state.range(1));
+  RunBatched(
+      state,
+      [&] {
+        return std::make_pair(NewGList(keys), static_cast<GList *>(nullptr));
+      },
+      [=](auto &p) {
+        // GList has no range splice: the range is cut after its last node
+        // and linked after the last node of the other list, which is kept
+        // so that g_list_concat() does not walk to it.
+        GList *tail = nullptr;
+        while (p.first != nullptr) {
+          GList *last = p.first;
+          for (size_t i = 1; i < chunk && last->next != nullptr; ++i) {
+            last = last->next;
+          }
+          GList *rest = last->next;
+          if (rest != nullptr) {
+            rest->prev = nullptr;
+            last->next = nullptr;
+          }
+          if (tail == nullptr) {
+            p.second = p.first;
+          } else {
+            g_list_concat(tail, p.first);
+          }
+          tail = last;
+          p.first = rest;
+        }
+      },
+      [](auto &p) {
+        g_list_free(p.first);
+        g_list_free(p.second);
+      });
+}
+SPLICE(BENCHMARK(BM_Splice_GList));
+
+static void BM_Splice_CdcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto chunk = static_cast<size_t>(state.range(1));
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_list *to = nullptr;
+        cdc_list_ctor(&to, nullptr);
+        return std::make_pair(NewCdcList(keys), to);
+      },
+      [=](auto &p) {
+        for (size_t rest = keys.Size(); rest != 0;) {
+          const size_t count = std::min(chunk, rest);
+          struct cdc_list_iter first = {};
+          struct cdc_list_iter last = {};
+          struct cdc_list_iter position = {};
+          cdc_list_begin(p.first, &first);
+          last = first;
+          for (size_t i = 0; i < count; ++i) {
+            cdc_list_iter_next(&last);
+          }
+          cdc_list_end(p.second, &position);
+          cdc_list_splice(&position, &first, &last);
+          rest -= count;
+        }
+      },
+      [](auto &p) {
+        cdc_list_dtor(p.first);
+        cdc_list_dtor(p.second);
+      });
+}
+SPLICE(BENCHMARK(BM_Splice_CdcList));
+
+// Reverse benchmarks:
+static void BM_Reverse_CppList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCppList(keys); },
+      [](auto list) { list->reverse(); }, [](auto list) { delete list; });
+}
+S_ALGO(BENCHMARK(BM_Reverse_CppList));
+
+static void BM_Reverse_CcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCcList(keys); }, list_reverse, list_destroy);
+}
+S_ALGO(BENCHMARK(BM_Reverse_CcList));
+
+static void BM_Reverse_GList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewGList(keys); },
+      [](auto &list) { list = g_list_reverse(list); }, g_list_free);
+}
+S_ALGO(BENCHMARK(BM_Reverse_GList));
+
+static void BM_Reverse_CdcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCdcList(keys); }, cdc_list_reverse,
+      cdc_list_dtor);
+}
+S_ALGO(BENCHMARK(BM_Reverse_CdcList));
+
+// Remove if benchmarks:
+// Removes the odd keys, about half of the uniform keys of the list.
+// Collections-C keeps the elements its predicate holds for, and GList has
+// no predicate removal, so it walks the list with g_list_delete_link().
+static void BM_RemoveIf_CppList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCppList(keys); },
+      [](auto list) { list->remove_if([](int v) { return v % 2 != 0; }); },
+      [](auto list) { delete list; });
+}
+S_ALGO(BENCHMARK(BM_RemoveIf_CppList));
+
+static void BM_RemoveIf_CcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCcList(keys); },
+      [](auto list) { list_filter_mut(list, IsEven); }, list_destroy);
+}
+S_ALGO(BENCHMARK(BM_RemoveIf_CcList));
+
+static void BM_RemoveIf_GList(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GList *list = g_list_alloc();
-    for (int i = 1; i < 6; ++i) {
-      list = g_list_append(list, CDC_FROM_INT(i));
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewGList(keys); },
+      [](auto &list) {
+        GList *node = list;
+        while (node != nullptr) {
+          GList *next = node->next;
+          if (IsOdd(node->data)) {
+            list = g_list_delete_link(list, node);
+          }
+          node = next;
+        }
+      },
+      g_list_free);
+}
+S_ALGO(BENCHMARK(BM_RemoveIf_GList));
+
+static void BM_RemoveIf_CdcList(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCdcList(keys); },
+      [](auto list) { cdc_list_remove_if(list, IsOdd); }, cdc_list_dtor);
+}
+S_ALGO(BENCHMARK(BM_RemoveIf_CdcList));
+
+// Unique benchmarks:
+// Removes the second key of every pair of the sorted keys 0, 0, 1, 1, ...
+// GList and Collections-C List have no unique.
+static std::vector<int> PairedKeys(size_t size)
+{
+  std::vector<int> keys(size);
+  for (size_t i = 0; i < size; ++i) {
+    keys[i] = static_cast<int>(i / 2);
+  }
+  return keys;
+}
+
+static void BM_Unique_CppList(benchmark::State &state)
+{
+  const auto keys = PairedKeys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCppList(keys); },
+      [](auto list) { list->unique(); }, [](auto list) { delete list; });
+}
+S_ALGO(BENCHMARK(BM_Unique_CppList));
+
+static void BM_Unique_CdcList(benchmark::State &state)
+{
+  const auto keys = PairedKeys(static_cast<size_t>(state.range(0)));
+  struct cdc_data_info info = {};
+  info.eq = IsEquil;
+  RunBatched(
+      state, [&] { return NewCdcList(keys, &info); }, cdc_list_unique,
+      cdc_list_dtor);
+}
+S_ALGO(BENCHMARK(BM_Unique_CdcList));
+
+// Traversal benchmarks:
+// Lists of N uniform keys are walked node by node, whatever --key_dist says,
+// since the layout of random-position insertion relies on keys in random
+// order. The time of a node depends on where the nodes lie in memory, so
+// every list is built in three ways (`build`):
+//   0 - by push_back, so nodes follow each other in memory;
+//   1 - in the layout of insertion at random positions, where list order is a
+//       random permutation of allocation order. Inserting at random positions
+//       walks the list, so this layout is made by sorting the list of random
+//       keys instead, which relinks its nodes;
+//   2 - by push_back followed by kChurnRounds rounds of churn: each round
+//       erases about half of the nodes while walking the list and appends as
+//       many new ones, which reuse freed memory in whatever order the
+//       allocator hands it out.
+// Walks are read-only, so the lists of a run are built once.
+// With --perf_counters, llc_misses are reported per node.
+enum ListBuild {
+  kSequentialBuild,
+  kShuffledBuild,
+  kChurnedBuild,
+};
+
+static void TraversalArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddAlgoSizes(benchmark, {kSequentialBuild, kShuffledBuild, kChurnedBuild});
+}
+
+#define TRAVERSAL(benchmark) \
+  benchmark->Apply(TraversalArgs)->ArgNames({"", "build"})->UseManualTime()
+
+class ListLayout
+{
+ public:
+  static constexpr size_t kChurnRounds = 4;
+
+  explicit ListLayout(const benchmark::State &state)
+      : _keys(static_cast<size_t>(state.range(0)), KeyDist::kUniform),
+        _build(static_cast<ListBuild>(state.range(1)))
+  {
+    if (_build != kChurnedBuild) {
+      return;
     }
-    GList *it = g_list_find(list, CDC_FROM_INT(3));
-    state.ResumeTiming();
 
-    for (int j = 0; j < state.range(0); ++j) {
-      list = g_list_insert_before(list, it, CDC_FROM_INT(GetRandom()));
+    auto gen = MakeRandomEngine(
+        {kListChurnTag, static_cast<uint32_t>(_keys.Size())});
+    std::bernoulli_distribution dis(0.5);
+    _erased.resize(kChurnRounds * _keys.Size());
+    std::generate(std::begin(_erased), std::end(_erased),
+                  [&]() { return dis(gen); });
+  }
+
+  const KeyStream &Keys() const { return _keys; }
+  ListBuild Build() const { return _build; }
+
+  // Whether the round erases the i-th node in list order.
+  bool Erased(size_t round, size_t i) const
+  {
+    return _erased[round * _keys.Size() + i] != 0;
+  }
+
+  // A key that is not in the list, for lookups that walk all of it.
+  int MissingKey() const
+  {
+    std::vector<int> sorted(std::cbegin(_keys), std::cend(_keys));
+    std::sort(std::begin(sorted), std::end(sorted));
+    int key = 0;
+    while (std::binary_search(std::cbegin(sorted), std::cend(sorted), key)) {
+      ++key;
     }
+    return key;
+  }
 
-    state.PauseTiming();
-    g_list_free(list);
-    state.ResumeTiming();
+ private:
+  KeyStream _keys;
+  ListBuild _build;
+  std::vector<uint8_t> _erased;
+};
+
+static std::list<int> *BuildCppList(const ListLayout &layout)
+{
+  auto list = NewCppList(layout.Keys());
+  if (layout.Build() == kShuffledBuild) {
+    list->sort();
+  } else if (layout.Build() == kChurnedBuild) {
+    for (size_t round = 0; round < ListLayout::kChurnRounds; ++round) {
+      size_t i = 0;
+      size_t erased = 0;
+      for (auto it = std::begin(*list); it != std::end(*list); ++i) {
+        if (layout.Erased(round, i)) {
+          it = list->erase(it);
+          ++erased;
+        } else {
+          ++it;
+        }
+      }
+      for (size_t j = 0; j < erased; ++j) {
+        list->push_back(layout.Keys()[j]);
+      }
+    }
   }
+  return list;
 }
-S(BENCHMARK(BM_InsertMid_GList));
 
-static void BM_InsertMid_CdcList(benchmark::State &state)
+static List *BuildCcList(const ListLayout &layout)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_list *list = nullptr;
-    cdc_list_ctorl(&list, nullptr, CDC_FROM_INT(1), CDC_FROM_INT(2),
-                   CDC_FROM_INT(3), CDC_FROM_INT(4), CDC_FROM_INT(5), CDC_END);
-    struct cdc_list_iter it = {};
-    cdc_list_begin(list, &it);
-    while (cdc_list_iter_has_next(&it) &&
-           cdc_list_iter_data(&it) != CDC_FROM_INT(3)) {
-      cdc_list_iter_next(&it);
+  List *list = NewCcList(layout.Keys());
+  if (layout.Build() == kShuffledBuild) {
+    list_sort_in_place(list, CcElementCmp);
+  } else if (layout.Build() == kChurnedBuild) {
+    for (size_t round = 0; round < ListLayout::kChurnRounds; ++round) {
+      size_t i = 0;
+      size_t erased = 0;
+      ListIter iter = {};
+      list_iter_init(&iter, list);
+      void *value = nullptr;
+      while (list_iter_next(&iter, &value) != CC_ITER_END) {
+        if (layout.Erased(round, i++)) {
+          list_iter_remove(&iter, nullptr);
+          ++erased;
+        }
+      }
+      for (size_t j = 0; j < erased; ++j) {
+        list_add_last(list, CDC_FROM_INT(layout.Keys()[j]));
+      }
     }
-    state.ResumeTiming();
+  }
+  return list;
+}
 
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_list_iinsert(&it, CDC_FROM_INT(GetRandom()));
+static GList *BuildGList(const ListLayout &layout)
+{
+  GList *list = NewGList(layout.Keys());
+  if (layout.Build() == kShuffledBuild) {
+    list = g_list_sort(list, CcCmp);
+  } else if (layout.Build() == kChurnedBuild) {
+    for (size_t round = 0; round < ListLayout::kChurnRounds; ++round) {
+      size_t i = 0;
+      size_t erased = 0;
+      GList *last = nullptr;
+      GList *node = list;
+      while (node != nullptr) {
+        GList *next = node->next;
+        if (layout.Erased(round, i++)) {
+          list = g_list_delete_link(list, node);
+          ++erased;
+        } else {
+          last = node;
+        }
+        node = next;
+      }
+      // Links new nodes after the last one rather than with g_list_append(),
+      // which walks the list.
+      for (size_t j = 0; j < erased; ++j) {
+        node = g_list_prepend(nullptr, CDC_FROM_INT(layout.Keys()[j]));
+        if (last == nullptr) {
+          list = node;
+        } else {
+          g_list_concat(last, node);
+        }
+        last = node;
+      }
     }
+  }
+  return list;
+}
 
-    state.PauseTiming();
-    cdc_list_dtor(list);
-    state.ResumeTiming();
+static struct cdc_list *BuildCdcList(const ListLayout &layout,
+                                     struct cdc_data_info *info)
+{
+  struct cdc_list *list = NewCdcList(layout.Keys(), info);
+  if (layout.Build() == kShuffledBuild) {
+    cdc_list_sort(list);
+  } else if (layout.Build() == kChurnedBuild) {
+    for (size_t round = 0; round < ListLayout::kChurnRounds; ++round) {
+      size_t i = 0;
+      size_t erased = 0;
+      struct cdc_list_iter it = {};
+      cdc_list_begin(list, &it);
+      while (cdc_list_iter_has_next(&it)) {
+        if (layout.Erased(round, i++)) {
+          // Erasing moves the iterator to the next node.
+          cdc_list_ierase(&it);
+          ++erased;
+        } else {
+          cdc_list_iter_next(&it);
+        }
+      }
+      for (size_t j = 0; j < erased; ++j) {
+        cdc_list_push_back(list, CDC_FROM_INT(layout.Keys()[j]));
+      }
+    }
   }
+  return list;
 }
-S(BENCHMARK(BM_InsertMid_CdcList));
 
-BENCHMARK_MAIN();
+// Traversal benchmarks visit every node with the walk of the library:
+// g_list_foreach(), list_foreach() and iterators.
+static void BM_Traversal_CppList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  RunReused(
+      state, [&] { return BuildCppList(layout); },
+      [](auto list) {
+        for (auto &value : *list) {
+          benchmark::DoNotOptimize(value);
+        }
+      },
+      [](auto list) { delete list; });
+}
+TRAVERSAL(BENCHMARK(BM_Traversal_CppList));
+
+static void Visit(void *value) { benchmark::DoNotOptimize(value); }
+
+static void BM_Traversal_CcList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  RunReused(
+      state, [&] { return BuildCcList(layout); },
+      [](auto list) { list_foreach(list, Visit); }, list_destroy);
+}
+TRAVERSAL(BENCHMARK(BM_Traversal_CcList));
+
+static void BM_Traversal_GList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  RunReused(
+      state, [&] { return BuildGList(layout); },
+      [](auto list) {
+        g_list_foreach(
+            list, [](gpointer value, gpointer) { Visit(value); }, nullptr);
+      },
+      g_list_free);
+}
+TRAVERSAL(BENCHMARK(BM_Traversal_GList));
+
+static void BM_Traversal_CdcList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  struct cdc_data_info info = {};
+  info.cmp = Less;
+  RunReused(
+      state, [&] { return BuildCdcList(layout, &info); },
+      [](auto list) {
+        struct cdc_list_iter it = {};
+        cdc_list_begin(list, &it);
+        while (cdc_list_iter_has_next(&it)) {
+          benchmark::DoNotOptimize(cdc_list_iter_data(&it));
+          cdc_list_iter_next(&it);
+        }
+      },
+      cdc_list_dtor);
+}
+TRAVERSAL(BENCHMARK(BM_Traversal_CdcList));
+
+// Find benchmarks look up a key that is not in the list, so every lookup
+// walks all of it. cdc_list has no find, so it walks with its iterator.
+static void BM_Find_CppList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  const int key = layout.MissingKey();
+  RunReused(
+      state, [&] { return BuildCppList(layout); },
+      [=](auto list) {
+        benchmark::DoNotOptimize(
+            std::find(std::cbegin(*list), std::cend(*list), key));
+      },
+      [](auto list) { delete list; });
+}
+TRAVERSAL(BENCHMARK(BM_Find_CppList));
+
+static void BM_Find_CcList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  const int key = layout.MissingKey();
+  RunReused(
+      state, [&] { return BuildCcList(layout); },
+      [=](auto list) {
+        size_t index = 0;
+        benchmark::DoNotOptimize(
+            list_index_of(list, CDC_FROM_INT(key), CcCmp, &index));
+      },
+      list_destroy);
+}
+TRAVERSAL(BENCHMARK(BM_Find_CcList));
+
+static void BM_Find_GList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  const int key = layout.MissingKey();
+  RunReused(
+      state, [&] { return BuildGList(layout); },
+      [=](auto list) {
+        benchmark::DoNotOptimize(g_list_find(list, CDC_FROM_INT(key)));
+      },
+      g_list_free);
+}
+TRAVERSAL(BENCHMARK(BM_Find_GList));
+
+static void BM_Find_CdcList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  const int key = layout.MissingKey();
+  struct cdc_data_info info = {};
+  info.cmp = Less;
+  RunReused(
+      state, [&] { return BuildCdcList(layout, &info); },
+      [=](auto list) {
+        struct cdc_list_iter it = {};
+        cdc_list_begin(list, &it);
+        while (cdc_list_iter_has_next(&it) &&
+               cdc_list_iter_data(&it) != CDC_FROM_INT(key)) {
+          cdc_list_iter_next(&it);
+        }
+        benchmark::DoNotOptimize(it);
+      },
+      cdc_list_dtor);
+}
+TRAVERSAL(BENCHMARK(BM_Find_CdcList));
+
+// Sum benchmarks add up the keys of all nodes with iterators.
+static void BM_Sum_CppList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  RunReused(
+      state, [&] { return BuildCppList(layout); },
+      [](auto list) {
+        benchmark::DoNotOptimize(
+            std::accumulate(std::cbegin(*list), std::cend(*list), int64_t{0}));
+      },
+      [](auto list) { delete list; });
+}
+TRAVERSAL(BENCHMARK(BM_Sum_CppList));
+
+static void BM_Sum_CcList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  RunReused(
+      state, [&] { return BuildCcList(layout); },
+      [](auto list) {
+        int64_t sum = 0;
+        ListIter iter = {};
+        list_iter_init(&iter, list);
+        void *value = nullptr;
+        while (list_iter_next(&iter, &value) != CC_ITER_END) {
+          sum += CDC_TO_INT(value);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      list_destroy);
+}
+TRAVERSAL(BENCHMARK(BM_Sum_CcList));
+
+static void BM_Sum_GList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  RunReused(
+      state, [&] { return BuildGList(layout); },
+      [](auto list) {
+        int64_t sum = 0;
+        for (GList *node = list; node != nullptr; node = node->next) {
+          sum += CDC_TO_INT(node->data);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      g_list_free);
+}
+TRAVERSAL(BENCHMARK(BM_Sum_GList));
+
+static void BM_Sum_CdcList(benchmark::State &state)
+{
+  const ListLayout layout(state);
+  struct cdc_data_info info = {};
+  info.cmp = Less;
+  RunReused(
+      state, [&] { return BuildCdcList(layout, &info); },
+      [](auto list) {
+        int64_t sum = 0;
+        struct cdc_list_iter it = {};
+        cdc_list_begin(list, &it);
+        while (cdc_list_iter_has_next(&it)) {
+          sum += CDC_TO_INT(cdc_list_iter_data(&it));
+          cdc_list_iter_next(&it);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      cdc_list_dtor);
+}
+TRAVERSAL(BENCHMARK(BM_Sum_CdcList));
+
+BENCH_MAIN();
@@ -27,10 +27,23 @@ extern "C" {
 
 #include <benchmark/benchmark.h>
 
+#include "benchmarks/interleaved.hpp"
+#include "benchmarks/latency.hpp"
+#include "benchmarks/maps.hpp"
+#include "benchmarks/pmr.hpp"
+#include "benchmarks/shape_stats.hpp"
+#include "benchmarks/typed_maps.hpp"
 #include "benchmarks/utils.hpp"
+#include "benchmarks/workload.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <initializer_list>
 #include <map>
+#include <memory_resource>
 #include <unordered_map>
+#include <vector>
 
 gboolean GTraverse(gpointer key, gpointer value, gpointer data)
 {
@@ -38,130 +51,128 @@ gboolean GTraverse(gpointer key, gpointer value, gpointer data)
   return false;
 }
 
+
 // Insert benchmarks:
 template <class Container>
 static void BM_Insert_Cpp(benchmark::State &state)
 {
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto c = new Container;
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      c->emplace(GetRandom(), value);
-    }
-
-    state.PauseTiming();
-    delete c;
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state, [] { return new Container; },
+      [&](auto c) {
+        for (auto key : keys) {
+          c->emplace(key, value);
+        }
+      },
+      [](auto c) { delete c; });
 }
 S(BENCHMARK_TEMPLATE(BM_Insert_Cpp, std::map<int, void *>));
 S(BENCHMARK_TEMPLATE(BM_Insert_Cpp, std::unordered_map<int, void *>));
+S(BENCHMARK_TEMPLATE(BM_Insert_Cpp,
+                     CppPmrMap<std::pmr::monotonic_buffer_resource>));
+S(BENCHMARK_TEMPLATE(BM_Insert_Cpp,
+                     CppPmrMap<std::pmr::unsynchronized_pool_resource>));
 
 static void BM_Insert_CcHashTable(benchmark::State &state)
 {
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
   HashTableConf conf;
   hashtable_conf_init(&conf);
   conf.key_compare = IsEquil;
   conf.hash = CcHash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    HashTable *table = nullptr;
-    hashtable_new_conf(&conf, &table);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      hashtable_add(table, CDC_FROM_INT(GetRandom()), nullptr);
-    }
-
-    state.PauseTiming();
-    hashtable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        HashTable *table = nullptr;
+        hashtable_new_conf(&conf, &table);
+        return table;
+      },
+      [&](auto table) {
+        for (auto key : keys) {
+          hashtable_add(table, CDC_FROM_INT(key), nullptr);
+        }
+      },
+      hashtable_destroy);
 }
 S(BENCHMARK(BM_Insert_CcHashTable));
 
 static void BM_Insert_CcTreeTable(benchmark::State &state)
 {
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
   TreeTableConf conf;
   treetable_conf_init(&conf);
   conf.cmp = CcCmp;
-  for (auto _ : state) {
-    state.PauseTiming();
-    TreeTable *table;
-    treetable_new_conf(&conf, &table);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      treetable_add(table, CDC_FROM_INT(GetRandom()), nullptr);
-    }
-
-    state.PauseTiming();
-    treetable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        TreeTable *table = nullptr;
+        treetable_new_conf(&conf, &table);
+        return table;
+      },
+      [&](auto table) {
+        for (auto key : keys) {
+          treetable_add(table, CDC_FROM_INT(key), nullptr);
+        }
+      },
+      treetable_destroy);
 }
 S(BENCHMARK(BM_Insert_CcTreeTable));
 
 static void BM_Insert_GTree(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GTree *tree = g_tree_new(CcCmp);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      g_tree_insert(tree, CDC_FROM_INT(GetRandom()), nullptr);
-    }
-
-    state.PauseTiming();
-    g_tree_destroy(tree);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return g_tree_new(CcCmp); },
+      [&](auto tree) {
+        for (auto key : keys) {
+          g_tree_insert(tree, CDC_FROM_INT(key), nullptr);
+        }
+      },
+      g_tree_destroy);
 }
 S(BENCHMARK(BM_Insert_GTree));
 
 static void BM_Insert_GHashTable(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GHashTable *table = g_hash_table_new(GHash, IsEquil);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      g_hash_table_insert(table, CDC_FROM_INT(GetRandom()), nullptr);
-    }
-
-    state.PauseTiming();
-    g_hash_table_destroy(table);
-    state.ResumeTiming();
-  }
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return g_hash_table_new(GHash, IsEquil); },
+      [&](auto table) {
+        for (auto key : keys) {
+          g_hash_table_insert(table, CDC_FROM_INT(key), nullptr);
+        }
+      },
+      g_hash_table_destroy);
 }
 S(BENCHMARK(BM_Insert_GHashTable));
 
 static void BM_Insert_CdcMap(benchmark::State &state,
                              const struct cdc_map_table *table)
 {
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.cmp = Less;
   info.hash = Hash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_map *map = nullptr;
-    cdc_map_ctor(table, &map, &info);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_map_insert(map, CDC_FROM_INT(GetRandom()), nullptr, nullptr, nullptr);
-    }
-
-    state.PauseTiming();
-    cdc_map_dtor(map);
-    state.ResumeTiming();
-  }
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_map *map = nullptr;
+        cdc_map_ctor(table, &map, &info);
+        return map;
+      },
+      [&](auto map) {
+        for (auto key : keys) {
+          cdc_map_insert(map, CDC_FROM_INT(key), nullptr, nullptr, nullptr);
+        }
+      },
+      [&](auto map) {
+        shape.Add(map);
+        cdc_map_dtor(map);
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
 }
 S(BENCHMARK_CAPTURE(BM_Insert_CdcMap, hash_table, cdc_map_htable));
 S(BENCHMARK_CAPTURE(BM_Insert_CdcMap, avl_tree, cdc_map_avl));
@@ -170,188 +181,220 @@ S(BENCHMARK_CAPTURE(BM_Insert_CdcMap, splay_tree, cdc_map_splay));
 
 static void BM_Insert_CdcHashTable(benchmark::State &state)
 {
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.hash = Hash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_hash_table *map = nullptr;
-    cdc_hash_table_ctor(&map, &info);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_hash_table_insert(map, CDC_FROM_INT(GetRandom()), nullptr, nullptr,
-                            nullptr);
-    }
-
-    state.PauseTiming();
-    cdc_hash_table_dtor(map);
-    state.ResumeTiming();
-  }
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_hash_table *map = nullptr;
+        cdc_hash_table_ctor(&map, &info);
+        return map;
+      },
+      [&](auto map) {
+        for (auto key : keys) {
+          cdc_hash_table_insert(map, CDC_FROM_INT(key), nullptr, nullptr,
+                                nullptr);
+        }
+      },
+      [&](auto map) {
+        shape.Add(map);
+        cdc_hash_table_dtor(map);
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
 }
 S(BENCHMARK(BM_Insert_CdcHashTable));
 
 static void BM_Insert_CdcAvlTree(benchmark::State &state)
 {
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.cmp = Less;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_avl_tree *map = nullptr;
-    cdc_avl_tree_ctor(&map, &info);
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_avl_tree_insert1(map, CDC_FROM_INT(GetRandom()), nullptr, nullptr,
-                           nullptr);
-    }
-
-    state.PauseTiming();
-    cdc_avl_tree_dtor(map);
-    state.ResumeTiming();
-  }
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_avl_tree *map = nullptr;
+        cdc_avl_tree_ctor(&map, &info);
+        return map;
+      },
+      [&](auto map) {
+        for (auto key : keys) {
+          cdc_avl_tree_insert1(map, CDC_FROM_INT(key), nullptr, nullptr,
+                               nullptr);
+        }
+      },
+      [&](auto map) {
+        shape.Add(map);
+        cdc_avl_tree_dtor(map);
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
 }
 S(BENCHMARK(BM_Insert_CdcAvlTree));
 
+// In-tree copies of the cdcontainers maps with an inlined comparator and hash,
+// to compare with calls through cdc_data_info, and in-tree reference maps of
+// other designs: an open-addressing hash table and a B+-tree.
+template <class Map>
+static void BM_Insert_Typed(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  ShapeCounters shape;
+  RunBatched(
+      state, [] { return new Map; },
+      [&](auto map) {
+        for (auto key : keys) {
+          map->Insert(CDC_FROM_INT(key), nullptr);
+        }
+      },
+      [&](auto map) {
+        shape.Add(map);
+        delete map;
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
+}
+S(BENCHMARK_TEMPLATE(BM_Insert_Typed, TypedHashTable<IntHash, IntEqual>));
+S(BENCHMARK_TEMPLATE(BM_Insert_Typed, TypedAvlTree<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Insert_Typed, TypedTreap<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Insert_Typed, TypedSplayTree<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Insert_Typed, FlatHashTable<IntHash, IntEqual>));
+S(BENCHMARK_TEMPLATE(BM_Insert_Typed, BPlusTree<IntLess>));
+
 // Remove benchmarks:
 template <class Container>
 static void BM_Remove_Cpp(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto c = new Container;
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { c->emplace(v, value); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      c->erase(rs.Get());
-    }
-
-    state.PauseTiming();
-    delete c;
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        auto c = new Container;
+        rs.ForEach([&](auto v) { c->emplace(v, value); });
+        return c;
+      },
+      [&](auto c) { rs.ReverseForEach([&](auto v) { c->erase(v); }); },
+      [](auto c) { delete c; });
 }
 S(BENCHMARK_TEMPLATE(BM_Remove_Cpp, std::map<int, void *>));
 S(BENCHMARK_TEMPLATE(BM_Remove_Cpp, std::unordered_map<int, void *>));
+S(BENCHMARK_TEMPLATE(BM_Remove_Cpp,
+                     CppPmrMap<std::pmr::monotonic_buffer_resource>));
+S(BENCHMARK_TEMPLATE(BM_Remove_Cpp,
+                     CppPmrMap<std::pmr::unsynchronized_pool_resource>));
 
 static void BM_Remove_CcHashTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   HashTableConf conf;
   hashtable_conf_init(&conf);
   conf.key_compare = IsEquil;
   conf.hash = CcHash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    HashTable *table = nullptr;
-    hashtable_new_conf(&conf, &table);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { hashtable_add(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      hashtable_remove(table, CDC_FROM_INT(rs.Get()), nullptr);
-    }
-
-    state.PauseTiming();
-    hashtable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        HashTable *table = nullptr;
+        hashtable_new_conf(&conf, &table);
+        rs.ForEach(
+            [&](auto v) { hashtable_add(table, CDC_FROM_INT(v), nullptr); });
+        return table;
+      },
+      [&](auto table) {
+        rs.ReverseForEach([&](auto v) {
+          hashtable_remove(table, CDC_FROM_INT(v), nullptr);
+        });
+      },
+      hashtable_destroy);
 }
 S(BENCHMARK(BM_Remove_CcHashTable));
 
 static void BM_Remove_CcTreeTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   TreeTableConf conf;
   treetable_conf_init(&conf);
   conf.cmp = CcCmp;
-  for (auto _ : state) {
-    state.PauseTiming();
-    TreeTable *table = nullptr;
-    treetable_new_conf(&conf, &table);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { treetable_add(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      treetable_remove(table, CDC_FROM_INT(rs.Get()), nullptr);
-    }
-
-    state.PauseTiming();
-    treetable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        TreeTable *table = nullptr;
+        treetable_new_conf(&conf, &table);
+        rs.ForEach(
+            [&](auto v) { treetable_add(table, CDC_FROM_INT(v), nullptr); });
+        return table;
+      },
+      [&](auto table) {
+        rs.ReverseForEach([&](auto v) {
+          treetable_remove(table, CDC_FROM_INT(v), nullptr);
+        });
+      },
+      treetable_destroy);
 }
 S(BENCHMARK(BM_Remove_CcTreeTable));
 
 static void BM_Remove_GTree(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GTree *tree = g_tree_new(CcCmp);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { g_tree_insert(tree, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      g_tree_remove(tree, CDC_FROM_INT(rs.Get()));
-    }
-
-    state.PauseTiming();
-    g_tree_destroy(tree);
-    state.ResumeTiming();
-  }
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        GTree *tree = g_tree_new(CcCmp);
+        rs.ForEach(
+            [&](auto v) { g_tree_insert(tree, CDC_FROM_INT(v), nullptr); });
+        return tree;
+      },
+      [&](auto tree) {
+        rs.ReverseForEach(
+            [&](auto v) { g_tree_remove(tree, CDC_FROM_INT(v)); });
+      },
+      g_tree_destroy);
 }
 S(BENCHMARK(BM_Remove_GTree));
 
 static void BM_Remove_GHashTable(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GHashTable *table = g_hash_table_new(GHash, IsEquil);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach(
-        [&](auto v) { g_hash_table_insert(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      g_hash_table_remove(table, CDC_FROM_INT(rs.Get()));
-    }
-
-    state.PauseTiming();
-    g_hash_table_destroy(table);
-    state.ResumeTiming();
-  }
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        GHashTable *table = g_hash_table_new(GHash, IsEquil);
+        rs.ForEach([&](auto v) {
+          g_hash_table_insert(table, CDC_FROM_INT(v), nullptr);
+        });
+        return table;
+      },
+      [&](auto table) {
+        rs.ReverseForEach(
+            [&](auto v) { g_hash_table_remove(table, CDC_FROM_INT(v)); });
+      },
+      g_hash_table_destroy);
 }
 S(BENCHMARK(BM_Remove_GHashTable));
 
 static void BM_Remove_CdcMap(benchmark::State &state,
                              const struct cdc_map_table *table)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.cmp = Less;
   info.hash = Hash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_map *map = nullptr;
-    cdc_map_ctor(table, &map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_map_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_map_erase(map, CDC_FROM_INT(rs.Get()));
-    }
-
-    state.PauseTiming();
-    cdc_map_dtor(map);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_map *map = nullptr;
+        cdc_map_ctor(table, &map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_map_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
+        });
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach([=](auto v) { cdc_map_erase(map, CDC_FROM_INT(v)); });
+      },
+      cdc_map_dtor);
 }
 S(BENCHMARK_CAPTURE(BM_Remove_CdcMap, hash_table, cdc_map_htable));
 S(BENCHMARK_CAPTURE(BM_Remove_CdcMap, avl_tree, cdc_map_avl));
@@ -360,201 +403,231 @@ S(BENCHMARK_CAPTURE(BM_Remove_CdcMap, splay_tree, cdc_map_splay));
 
 static void BM_Remove_CdcHashTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.hash = Hash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_hash_table *map = nullptr;
-    cdc_hash_table_ctor(&map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_hash_table_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_hash_table_erase(map, CDC_FROM_INT(rs.Get()));
-    }
-
-    state.PauseTiming();
-    cdc_hash_table_dtor(map);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_hash_table *map = nullptr;
+        cdc_hash_table_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_hash_table_insert(map, CDC_FROM_INT(v), nullptr, nullptr,
+                                nullptr);
+        });
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach(
+            [=](auto v) { cdc_hash_table_erase(map, CDC_FROM_INT(v)); });
+      },
+      cdc_hash_table_dtor);
 }
 S(BENCHMARK(BM_Remove_CdcHashTable));
 
 static void BM_Remove_CdcAvlTree(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.cmp = Less;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_avl_tree *map = nullptr;
-    cdc_avl_tree_ctor(&map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_avl_tree_insert1(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      cdc_avl_tree_erase(map, CDC_FROM_INT(rs.Get()));
-    }
-
-    state.PauseTiming();
-    cdc_avl_tree_dtor(map);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_avl_tree *map = nullptr;
+        cdc_avl_tree_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_avl_tree_insert1(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
+        });
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach(
+            [=](auto v) { cdc_avl_tree_erase(map, CDC_FROM_INT(v)); });
+      },
+      cdc_avl_tree_dtor);
 }
 S(BENCHMARK(BM_Remove_CdcAvlTree));
 
+template <class Map>
+static void BM_Remove_Typed(benchmark::State &state)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        auto map = new Map;
+        rs.ForEach([=](auto v) { map->Insert(CDC_FROM_INT(v), nullptr); });
+        shape.Start(map);
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach([=](auto v) { map->Erase(CDC_FROM_INT(v)); });
+      },
+      [&](auto map) {
+        shape.Add(map);
+        delete map;
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
+}
+S(BENCHMARK_TEMPLATE(BM_Remove_Typed, TypedHashTable<IntHash, IntEqual>));
+S(BENCHMARK_TEMPLATE(BM_Remove_Typed, TypedAvlTree<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Remove_Typed, TypedTreap<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Remove_Typed, TypedSplayTree<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Remove_Typed, FlatHashTable<IntHash, IntEqual>));
+S(BENCHMARK_TEMPLATE(BM_Remove_Typed, BPlusTree<IntLess>));
+
 // Search benchmarks:
 template <class Container>
 static void BM_Search_Cpp(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto c = new Container;
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { c->emplace(v, value); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(c->operator[](rs.Get()));
-    }
-
-    state.PauseTiming();
-    delete c;
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        auto c = new Container;
+        rs.ForEach([&](auto v) { c->emplace(v, value); });
+        return c;
+      },
+      [&](auto c) {
+        rs.ReverseForEach(
+            [&](auto v) { benchmark::DoNotOptimize(c->operator[](v)); });
+      },
+      [](auto c) { delete c; });
 }
 S(BENCHMARK_TEMPLATE(BM_Search_Cpp, std::map<int, void *>));
 S(BENCHMARK_TEMPLATE(BM_Search_Cpp, std::unordered_map<int, void *>));
+S(BENCHMARK_TEMPLATE(BM_Search_Cpp,
+                     CppPmrMap<std::pmr::monotonic_buffer_resource>));
+S(BENCHMARK_TEMPLATE(BM_Search_Cpp,
+                     CppPmrMap<std::pmr::unsynchronized_pool_resource>));
 
 static void BM_Search_CcHashTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   HashTableConf conf;
   hashtable_conf_init(&conf);
   conf.key_compare = IsEquil;
   conf.hash = CcHash;
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    HashTable *table = nullptr;
-    hashtable_new_conf(&conf, &table);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { hashtable_add(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(
-          hashtable_get(table, CDC_FROM_INT(rs.Get()), &value));
-    }
-
-    state.PauseTiming();
-    hashtable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        HashTable *table = nullptr;
+        hashtable_new_conf(&conf, &table);
+        rs.ForEach(
+            [&](auto v) { hashtable_add(table, CDC_FROM_INT(v), nullptr); });
+        return table;
+      },
+      [&](auto table) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(
+              hashtable_get(table, CDC_FROM_INT(v), &value));
+        });
+      },
+      hashtable_destroy);
 }
 S(BENCHMARK(BM_Search_CcHashTable));
 
 static void BM_Search_CcTreeTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   TreeTableConf conf;
   treetable_conf_init(&conf);
   conf.cmp = CcCmp;
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    TreeTable *table = nullptr;
-    treetable_new_conf(&conf, &table);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { treetable_add(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(
-          treetable_get(table, CDC_FROM_INT(rs.Get()), &value));
-    }
-
-    state.PauseTiming();
-    treetable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        TreeTable *table = nullptr;
+        treetable_new_conf(&conf, &table);
+        rs.ForEach(
+            [&](auto v) { treetable_add(table, CDC_FROM_INT(v), nullptr); });
+        return table;
+      },
+      [&](auto table) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(
+              treetable_get(table, CDC_FROM_INT(v), &value));
+        });
+      },
+      treetable_destroy);
 }
 S(BENCHMARK(BM_Search_CcTreeTable));
 
 static void BM_Search_GTree(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GTree *tree = g_tree_new(CcCmp);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { g_tree_insert(tree, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(g_tree_lookup(tree, CDC_FROM_INT(rs.Get())));
-    }
-
-    state.PauseTiming();
-    g_tree_destroy(tree);
-    state.ResumeTiming();
-  }
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        GTree *tree = g_tree_new(CcCmp);
+        rs.ForEach(
+            [&](auto v) { g_tree_insert(tree, CDC_FROM_INT(v), nullptr); });
+        return tree;
+      },
+      [&](auto tree) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(g_tree_lookup(tree, CDC_FROM_INT(v)));
+        });
+      },
+      g_tree_destroy);
 }
 S(BENCHMARK(BM_Search_GTree));
 
 static void BM_Search_GHashTable(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GHashTable *table = g_hash_table_new(GHash, IsEquil);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach(
-        [&](auto v) { g_hash_table_insert(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(
-          g_hash_table_lookup(table, CDC_FROM_INT(rs.Get())));
-    }
-
-    state.PauseTiming();
-    g_hash_table_destroy(table);
-    state.ResumeTiming();
-  }
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        GHashTable *table = g_hash_table_new(GHash, IsEquil);
+        rs.ForEach([&](auto v) {
+          g_hash_table_insert(table, CDC_FROM_INT(v), nullptr);
+        });
+        return table;
+      },
+      [&](auto table) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(g_hash_table_lookup(table, CDC_FROM_INT(v)));
+        });
+      },
+      g_hash_table_destroy);
 }
 S(BENCHMARK(BM_Search_GHashTable));
 
 static void BM_Search_CdcMap(benchmark::State &state,
                              const struct cdc_map_table *table)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.cmp = Less;
   info.hash = Hash;
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_map *map = nullptr;
-    cdc_map_ctor(table, &map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_map_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(
-          cdc_map_get(map, CDC_FROM_INT(rs.Get()), &value));
-    }
-
-    state.PauseTiming();
-    cdc_map_dtor(map);
-    state.ResumeTiming();
-  }
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_map *map = nullptr;
+        cdc_map_ctor(table, &map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_map_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
+        });
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(cdc_map_get(map, CDC_FROM_INT(v), &value));
+        });
+      },
+      [&](auto map) {
+        shape.Add(map);
+        cdc_map_dtor(map);
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
 }
 S(BENCHMARK_CAPTURE(BM_Search_CdcMap, hash_table, cdc_map_htable));
 S(BENCHMARK_CAPTURE(BM_Search_CdcMap, avl_tree, cdc_map_avl));
@@ -563,212 +636,249 @@ S(BENCHMARK_CAPTURE(BM_Search_CdcMap, splay_tree, cdc_map_splay));
 
 static void BM_Search_CdcHashTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.hash = Hash;
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_hash_table *map = nullptr;
-    cdc_hash_table_ctor(&map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_hash_table_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(
-          cdc_hash_table_get(map, CDC_FROM_INT(rs.Get()), &value));
-    }
-
-    state.PauseTiming();
-    cdc_hash_table_dtor(map);
-    state.ResumeTiming();
-  }
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_hash_table *map = nullptr;
+        cdc_hash_table_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_hash_table_insert(map, CDC_FROM_INT(v), nullptr, nullptr,
+                                nullptr);
+        });
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(
+              cdc_hash_table_get(map, CDC_FROM_INT(v), &value));
+        });
+      },
+      [&](auto map) {
+        shape.Add(map);
+        cdc_hash_table_dtor(map);
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
 }
 S(BENCHMARK(BM_Search_CdcHashTable));
 
 static void BM_Search_CdcAvlTree(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.cmp = Less;
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_avl_tree *map = nullptr;
-    cdc_avl_tree_ctor(&map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_avl_tree_insert1(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    for (int j = 0; j < state.range(0); ++j) {
-      benchmark::DoNotOptimize(
-          cdc_avl_tree_get(map, CDC_FROM_INT(rs.Get()), &value));
-    }
-
-    state.PauseTiming();
-    cdc_avl_tree_dtor(map);
-    state.ResumeTiming();
-  }
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_avl_tree *map = nullptr;
+        cdc_avl_tree_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_avl_tree_insert1(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
+        });
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(
+              cdc_avl_tree_get(map, CDC_FROM_INT(v), &value));
+        });
+      },
+      [&](auto map) {
+        shape.Add(map);
+        cdc_avl_tree_dtor(map);
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
 }
 S(BENCHMARK(BM_Search_CdcAvlTree));
 
+template <class Map>
+static void BM_Search_Typed(benchmark::State &state)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  void *value = nullptr;
+  ShapeCounters shape;
+  RunBatched(
+      state,
+      [&] {
+        auto map = new Map;
+        rs.ForEach([=](auto v) { map->Insert(CDC_FROM_INT(v), nullptr); });
+        shape.Start(map);
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(map->Get(CDC_FROM_INT(v), &value));
+        });
+      },
+      [&](auto map) {
+        shape.Add(map);
+        delete map;
+      });
+  shape.Report(state, static_cast<double>(state.range(0)));
+}
+S(BENCHMARK_TEMPLATE(BM_Search_Typed, TypedHashTable<IntHash, IntEqual>));
+S(BENCHMARK_TEMPLATE(BM_Search_Typed, TypedAvlTree<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Search_Typed, TypedTreap<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Search_Typed, TypedSplayTree<IntLess>));
+S(BENCHMARK_TEMPLATE(BM_Search_Typed, FlatHashTable<IntHash, IntEqual>));
+S(BENCHMARK_TEMPLATE(BM_Search_Typed, BPlusTree<IntLess>));
+
 // Iterator traversal benchmarks:
 template <class Container>
 static void BM_ItTraversal_Cpp(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    auto c = new Container;
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { c->emplace(v, value); });
-    state.ResumeTiming();
-
-    auto end = std::end(*c);
-    for (auto it = std::begin(*c); it != end; ++it) {
-      benchmark::DoNotOptimize(it->second);
-    }
-
-    state.PauseTiming();
-    delete c;
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        auto c = new Container;
+        rs.ForEach([&](auto v) { c->emplace(v, value); });
+        return c;
+      },
+      [](auto c) {
+        auto end = std::end(*c);
+        for (auto it = std::begin(*c); it != end; ++it) {
+          benchmark::DoNotOptimize(it->second);
+        }
+      },
+      [](auto c) { delete c; });
 }
 S(BENCHMARK_TEMPLATE(BM_ItTraversal_Cpp, std::map<int, void *>));
 S(BENCHMARK_TEMPLATE(BM_ItTraversal_Cpp, std::unordered_map<int, void *>));
 
 static void BM_ItTraversal_CcHashTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   HashTableConf conf;
   hashtable_conf_init(&conf);
   conf.key_compare = IsEquil;
   conf.hash = CcHash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    HashTable *table = nullptr;
-    hashtable_new_conf(&conf, &table);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { hashtable_add(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    HashTableIter it;
-    hashtable_iter_init(&it, table);
-    TableEntry *entry;
-    while (hashtable_iter_next(&it, &entry) != CC_ITER_END) {
-      benchmark::DoNotOptimize(entry->value);
-    }
-
-    state.PauseTiming();
-    hashtable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        HashTable *table = nullptr;
+        hashtable_new_conf(&conf, &table);
+        rs.ForEach(
+            [&](auto v) { hashtable_add(table, CDC_FROM_INT(v), nullptr); });
+        return table;
+      },
+      [](auto table) {
+        HashTableIter it;
+        hashtable_iter_init(&it, table);
+        TableEntry *entry;
+        while (hashtable_iter_next(&it, &entry) != CC_ITER_END) {
+          benchmark::DoNotOptimize(entry->value);
+        }
+      },
+      hashtable_destroy);
 }
 S(BENCHMARK(BM_ItTraversal_CcHashTable));
 
 static void BM_ItTraversal_CcTreeTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   TreeTableConf conf;
   treetable_conf_init(&conf);
   conf.cmp = CcCmp;
-  for (auto _ : state) {
-    state.PauseTiming();
-    TreeTable *table = nullptr;
-    treetable_new_conf(&conf, &table);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { treetable_add(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    TreeTableIter it;
-    treetable_iter_init(&it, table);
-    TreeTableEntry entry;
-    while (treetable_iter_next(&it, &entry) != CC_ITER_END) {
-      benchmark::DoNotOptimize(entry.value);
-    }
-
-    state.PauseTiming();
-    treetable_destroy(table);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        TreeTable *table = nullptr;
+        treetable_new_conf(&conf, &table);
+        rs.ForEach(
+            [&](auto v) { treetable_add(table, CDC_FROM_INT(v), nullptr); });
+        return table;
+      },
+      [](auto table) {
+        TreeTableIter it;
+        treetable_iter_init(&it, table);
+        TreeTableEntry entry;
+        while (treetable_iter_next(&it, &entry) != CC_ITER_END) {
+          benchmark::DoNotOptimize(entry.value);
+        }
+      },
+      treetable_destroy);
 }
 S(BENCHMARK(BM_ItTraversal_CcTreeTable));
 
 static void BM_ItTraversal_GTree(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GTree *tree = g_tree_new(CcCmp);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([&](auto v) { g_tree_insert(tree, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    g_tree_foreach(tree, GTraverse, nullptr);
-
-    state.PauseTiming();
-    g_tree_destroy(tree);
-    state.ResumeTiming();
-  }
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        GTree *tree = g_tree_new(CcCmp);
+        rs.ForEach(
+            [&](auto v) { g_tree_insert(tree, CDC_FROM_INT(v), nullptr); });
+        return tree;
+      },
+      [](auto tree) { g_tree_foreach(tree, GTraverse, nullptr); },
+      g_tree_destroy);
 }
 S(BENCHMARK(BM_ItTraversal_GTree));
 
 static void BM_ItTraversal_GHashTable(benchmark::State &state)
 {
-  for (auto _ : state) {
-    state.PauseTiming();
-    GHashTable *table = g_hash_table_new(GHash, IsEquil);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach(
-        [&](auto v) { g_hash_table_insert(table, CDC_FROM_INT(v), nullptr); });
-    state.ResumeTiming();
-
-    GHashTableIter it;
-    g_hash_table_iter_init(&it, table);
-    void *key;
-    void *value;
-    while (g_hash_table_iter_next(&it, &key, &value)) {
-      benchmark::DoNotOptimize(value);
-    }
-
-    state.PauseTiming();
-    g_hash_table_destroy(table);
-    state.ResumeTiming();
-  }
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        GHashTable *table = g_hash_table_new(GHash, IsEquil);
+        rs.ForEach([&](auto v) {
+          g_hash_table_insert(table, CDC_FROM_INT(v), nullptr);
+        });
+        return table;
+      },
+      [](auto table) {
+        GHashTableIter it;
+        g_hash_table_iter_init(&it, table);
+        void *key;
+        void *value;
+        while (g_hash_table_iter_next(&it, &key, &value)) {
+          benchmark::DoNotOptimize(value);
+        }
+      },
+      g_hash_table_destroy);
 }
 S(BENCHMARK(BM_ItTraversal_GHashTable));
 
 static void BM_ItTraversal_CdcMap(benchmark::State &state,
                                   const struct cdc_map_table *table)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.cmp = Less;
   info.hash = Hash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_map *map = nullptr;
-    cdc_map_ctor(table, &map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_map_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    cdc_map_iter it;
-    cdc_map_iter_ctor(map, &it);
-    cdc_map_begin(map, &it);
-    while (cdc_map_iter_has_next(&it)) {
-      benchmark::DoNotOptimize(cdc_map_iter_value(&it));
-      cdc_map_iter_next(&it);
-    }
-    cdc_map_iter_dtor(&it);
-
-    state.PauseTiming();
-    cdc_map_dtor(map);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_map *map = nullptr;
+        cdc_map_ctor(table, &map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_map_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
+        });
+        return map;
+      },
+      [](auto map) {
+        cdc_map_iter it;
+        cdc_map_iter_ctor(map, &it);
+        cdc_map_begin(map, &it);
+        while (cdc_map_iter_has_next(&it)) {
+          benchmark::DoNotOptimize(cdc_map_iter_value(&it));
+          cdc_map_iter_next(&it);
+        }
+        cdc_map_iter_dtor(&it);
+      },
+      cdc_map_dtor);
 }
 S(BENCHMARK_CAPTURE(BM_ItTraversal_CdcMap, hash_table, cdc_map_htable));
 S(BENCHMARK_CAPTURE(BM_ItTraversal_CdcMap, avl_tree, cdc_map_avl));
@@ -777,60 +887,1549 @@ S(BENCHMARK_CAPTURE(BM_ItTraversal_CdcMap, splay_tree, cdc_map_splay));
 
 static void BM_ItTraversal_CdcHashTable(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.eq = IsEquil;
   info.hash = Hash;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_hash_table *map = nullptr;
-    cdc_hash_table_ctor(&map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_hash_table_insert(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    cdc_hash_table_iter it;
-    cdc_hash_table_begin(map, &it);
-    while (cdc_hash_table_iter_has_next(&it)) {
-      benchmark::DoNotOptimize(cdc_hash_table_iter_value(&it));
-      cdc_hash_table_iter_next(&it);
-    }
-
-    state.PauseTiming();
-    cdc_hash_table_dtor(map);
-    state.ResumeTiming();
-  }
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_hash_table *map = nullptr;
+        cdc_hash_table_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_hash_table_insert(map, CDC_FROM_INT(v), nullptr, nullptr,
+                                nullptr);
+        });
+        return map;
+      },
+      [](auto map) {
+        cdc_hash_table_iter it;
+        cdc_hash_table_begin(map, &it);
+        while (cdc_hash_table_iter_has_next(&it)) {
+          benchmark::DoNotOptimize(cdc_hash_table_iter_value(&it));
+          cdc_hash_table_iter_next(&it);
+        }
+      },
+      cdc_hash_table_dtor);
 }
 S(BENCHMARK(BM_ItTraversal_CdcHashTable));
 
 static void BM_ItTraversal_CdcAvlTree(benchmark::State &state)
 {
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
   struct cdc_data_info info = {};
   info.cmp = Less;
-  void *value = nullptr;
-  for (auto _ : state) {
-    state.PauseTiming();
-    struct cdc_avl_tree *map = nullptr;
-    cdc_avl_tree_ctor(&map, &info);
-    RandomSet rs(static_cast<size_t>(state.range(0)));
-    rs.ForEach([=](auto v) {
-      cdc_avl_tree_insert1(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
-    });
-    state.ResumeTiming();
-
-    cdc_avl_tree_iter it;
-    cdc_avl_tree_begin(map, &it);
-    while (cdc_avl_tree_iter_has_next(&it)) {
-      benchmark::DoNotOptimize(cdc_avl_tree_iter_value(&it));
-      cdc_avl_tree_iter_next(&it);
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_avl_tree *map = nullptr;
+        cdc_avl_tree_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_avl_tree_insert1(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
+        });
+        return map;
+      },
+      [](auto map) {
+        cdc_avl_tree_iter it;
+        cdc_avl_tree_begin(map, &it);
+        while (cdc_avl_tree_iter_has_next(&it)) {
+          benchmark::DoNotOptimize(cdc_avl_tree_iter_value(&it));
+          cdc_avl_tree_iter_next(&it);
+        }
+      },
+      cdc_avl_tree_dtor);
+}
+S(BENCHMARK(BM_ItTraversal_CdcAvlTree));
+
+// Only the in-tree reference maps iterate, the typed copies of cdcontainers
+// have no iterators.
+template <class Map>
+static void BM_ItTraversal_Typed(benchmark::State &state)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        auto map = new Map;
+        rs.ForEach([=](auto v) { map->Insert(CDC_FROM_INT(v), nullptr); });
+        return map;
+      },
+      [](auto map) {
+        map->ForEach([](void * /* key */, void *value) {
+          benchmark::DoNotOptimize(value);
+        });
+      },
+      [](auto map) { delete map; });
+}
+S(BENCHMARK_TEMPLATE(BM_ItTraversal_Typed, FlatHashTable<IntHash, IntEqual>));
+S(BENCHMARK_TEMPLATE(BM_ItTraversal_Typed, BPlusTree<IntLess>));
+
+// Mixed workload benchmarks:
+// Args are the resident size and weights of gets, inserts and erases.
+static void MixedArgs(benchmark::internal::Benchmark *benchmark)
+{
+  const int64_t weights[][3] = {{90, 8, 2}, {50, 25, 25}};
+  for (const auto &weight : weights) {
+    for (auto n : Sizes()) {
+      benchmark->Args({n, weight[0], weight[1], weight[2]});
     }
+  }
+}
+
+#define MIXED(benchmark)                         \
+  benchmark->Apply(MixedArgs)                    \
+      ->ArgNames({"", "get", "insert", "erase"}) \
+      ->UseManualTime()
+
+// Runs as many operations as the map holds keys.
+template <class Map, class... Args>
+static void RunMixed(benchmark::State &state, Args... args)
+{
+  const auto resident = static_cast<size_t>(state.range(0));
+  const MixedWorkload workload(resident, resident, state.range(1),
+                               state.range(2), state.range(3));
+  RunBatched(
+      state,
+      [&] {
+        auto map = new Map(args...);
+        for (auto key : workload.Resident()) {
+          map->Insert(key);
+        }
+        return map;
+      },
+      [&](auto map) {
+        for (const auto &op : workload) {
+          switch (op.op) {
+          case MapOp::kGet:
+            benchmark::DoNotOptimize(map->Find(op.key));
+            break;
+          case MapOp::kInsert:
+            map->Insert(op.key);
+            break;
+          case MapOp::kErase:
+            map->Erase(op.key);
+            break;
+          }
+        }
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Container>
+static void BM_Mixed_Cpp(benchmark::State &state)
+{
+  RunMixed<CppMap<Container>>(state);
+}
+MIXED(BENCHMARK_TEMPLATE(BM_Mixed_Cpp, std::map<int, void *>));
+MIXED(BENCHMARK_TEMPLATE(BM_Mixed_Cpp, std::unordered_map<int, void *>));
 
-    state.PauseTiming();
-    cdc_avl_tree_dtor(map);
-    state.ResumeTiming();
+static void BM_Mixed_CcHashTable(benchmark::State &state)
+{
+  RunMixed<CcHashTableMap>(state);
+}
+MIXED(BENCHMARK(BM_Mixed_CcHashTable));
+
+static void BM_Mixed_CcTreeTable(benchmark::State &state)
+{
+  RunMixed<CcTreeTableMap>(state);
+}
+MIXED(BENCHMARK(BM_Mixed_CcTreeTable));
+
+static void BM_Mixed_GTree(benchmark::State &state)
+{
+  RunMixed<GTreeMap>(state);
+}
+MIXED(BENCHMARK(BM_Mixed_GTree));
+
+static void BM_Mixed_GHashTable(benchmark::State &state)
+{
+  RunMixed<GHashTableMap>(state);
+}
+MIXED(BENCHMARK(BM_Mixed_GHashTable));
+
+static void BM_Mixed_CdcMap(benchmark::State &state,
+                            const struct cdc_map_table *table)
+{
+  RunMixed<CdcMap>(state, table);
+}
+MIXED(BENCHMARK_CAPTURE(BM_Mixed_CdcMap, hash_table, cdc_map_htable));
+MIXED(BENCHMARK_CAPTURE(BM_Mixed_CdcMap, avl_tree, cdc_map_avl));
+MIXED(BENCHMARK_CAPTURE(BM_Mixed_CdcMap, treep, cdc_map_treap));
+MIXED(BENCHMARK_CAPTURE(BM_Mixed_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_Mixed_CdcHashTable(benchmark::State &state)
+{
+  RunMixed<CdcHashTableMap>(state);
+}
+MIXED(BENCHMARK(BM_Mixed_CdcHashTable));
+
+static void BM_Mixed_CdcAvlTree(benchmark::State &state)
+{
+  RunMixed<CdcAvlTreeMap>(state);
+}
+MIXED(BENCHMARK(BM_Mixed_CdcAvlTree));
+
+// Bulk build benchmarks:
+// Args are the size and whether the keys come sorted (1) or shuffled (0). Build
+// benchmarks time building a map from an array of distinct keys, BuiltSearch
+// benchmarks time looking up every key in the map this leaves behind.
+static void BuildArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {0, 1});
+}
+
+#define BUILD(benchmark) \
+  benchmark->Apply(BuildArgs)->ArgNames({"", "sorted"})->UseManualTime()
+
+static std::vector<int> BuildKeys(const benchmark::State &state)
+{
+  std::vector<int> keys;
+  RandomSet(static_cast<size_t>(state.range(0))).ForEach([&](auto v) {
+    keys.push_back(v);
+  });
+  if (state.range(1) != 0) {
+    std::sort(std::begin(keys), std::end(keys));
   }
+  return keys;
 }
-S(BENCHMARK(BM_ItTraversal_CdcAvlTree));
 
-BENCHMARK_MAIN();
+// std::map built as its range constructor does: inserts hinted with the end,
+// which take amortized constant time for sorted keys.
+class CppHintedMap
+{
+ public:
+  void Insert(int key) { _c.emplace_hint(std::end(_c), key, nullptr); }
+  bool Find(int key) { return _c.find(key) != std::end(_c); }
+
+ private:
+  std::map<int, void *> _c;
+};
+
+// TypedAvlTree built bottom-up in linear time once the keys are sorted, the
+// baseline of how fast a balanced tree can be built at all.
+class BottomUpAvlTree : public TypedMap<TypedAvlTree<IntLess>>
+{
+ public:
+  void Build(const std::vector<int> &keys)
+  {
+    std::vector<void *> sorted(keys.size());
+    std::transform(std::begin(keys), std::end(keys), std::begin(sorted),
+                   [](auto key) { return CDC_FROM_INT(key); });
+    if (!std::is_sorted(std::begin(sorted), std::end(sorted), IntLess())) {
+      std::sort(std::begin(sorted), std::end(sorted), IntLess());
+    }
+    _map.Build(sorted.data(), sorted.size());
+  }
+};
+
+// Maps without a bulk interface are built one insert at a time.
+template <class Map>
+static void BuildMap(Map *map, const std::vector<int> &keys)
+{
+  for (auto key : keys) {
+    map->Insert(key);
+  }
+}
+
+static void BuildMap(BottomUpAvlTree *map, const std::vector<int> &keys)
+{
+  map->Build(keys);
+}
+
+template <class Map, class... Args>
+static void RunBuild(benchmark::State &state, Args... args)
+{
+  const auto keys = BuildKeys(state);
+  RunBatched(
+      state, [&] { return new Map(args...); },
+      [&](auto map) { BuildMap(map, keys); }, [](auto map) { delete map; });
+}
+
+template <class Map, class... Args>
+static void RunBuiltSearch(benchmark::State &state, Args... args)
+{
+  const auto keys = BuildKeys(state);
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        auto map = new Map(args...);
+        BuildMap(map, keys);
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach(
+            [&](auto v) { benchmark::DoNotOptimize(map->Find(v)); });
+      },
+      [](auto map) { delete map; });
+}
+
+static void BM_Build_CppMap(benchmark::State &state)
+{
+  RunBuild<CppMap<std::map<int, void *>>>(state);
+}
+BUILD(BENCHMARK(BM_Build_CppMap));
+
+static void BM_Build_CppHintedMap(benchmark::State &state)
+{
+  RunBuild<CppHintedMap>(state);
+}
+BUILD(BENCHMARK(BM_Build_CppHintedMap));
+
+static void BM_Build_CcTreeTable(benchmark::State &state)
+{
+  RunBuild<CcTreeTableMap>(state);
+}
+BUILD(BENCHMARK(BM_Build_CcTreeTable));
+
+static void BM_Build_GTree(benchmark::State &state)
+{
+  RunBuild<GTreeMap>(state);
+}
+BUILD(BENCHMARK(BM_Build_GTree));
+
+static void BM_Build_CdcMap(benchmark::State &state,
+                            const struct cdc_map_table *table)
+{
+  RunBuild<CdcMap>(state, table);
+}
+BUILD(BENCHMARK_CAPTURE(BM_Build_CdcMap, avl_tree, cdc_map_avl));
+BUILD(BENCHMARK_CAPTURE(BM_Build_CdcMap, treep, cdc_map_treap));
+BUILD(BENCHMARK_CAPTURE(BM_Build_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_Build_CdcAvlTree(benchmark::State &state)
+{
+  RunBuild<CdcAvlTreeMap>(state);
+}
+BUILD(BENCHMARK(BM_Build_CdcAvlTree));
+
+template <class Map>
+static void BM_Build_Typed(benchmark::State &state)
+{
+  RunBuild<TypedMap<Map>>(state);
+}
+BUILD(BENCHMARK_TEMPLATE(BM_Build_Typed, TypedAvlTree<IntLess>));
+BUILD(BENCHMARK_TEMPLATE(BM_Build_Typed, TypedTreap<IntLess>));
+BUILD(BENCHMARK_TEMPLATE(BM_Build_Typed, TypedSplayTree<IntLess>));
+
+static void BM_Build_BottomUpAvlTree(benchmark::State &state)
+{
+  RunBuild<BottomUpAvlTree>(state);
+}
+BUILD(BENCHMARK(BM_Build_BottomUpAvlTree));
+
+static void BM_BuiltSearch_CppMap(benchmark::State &state)
+{
+  RunBuiltSearch<CppMap<std::map<int, void *>>>(state);
+}
+BUILD(BENCHMARK(BM_BuiltSearch_CppMap));
+
+static void BM_BuiltSearch_CppHintedMap(benchmark::State &state)
+{
+  RunBuiltSearch<CppHintedMap>(state);
+}
+BUILD(BENCHMARK(BM_BuiltSearch_CppHintedMap));
+
+static void BM_BuiltSearch_CcTreeTable(benchmark::State &state)
+{
+  RunBuiltSearch<CcTreeTableMap>(state);
+}
+BUILD(BENCHMARK(BM_BuiltSearch_CcTreeTable));
+
+static void BM_BuiltSearch_GTree(benchmark::State &state)
+{
+  RunBuiltSearch<GTreeMap>(state);
+}
+BUILD(BENCHMARK(BM_BuiltSearch_GTree));
+
+static void BM_BuiltSearch_CdcMap(benchmark::State &state,
+                                  const struct cdc_map_table *table)
+{
+  RunBuiltSearch<CdcMap>(state, table);
+}
+BUILD(BENCHMARK_CAPTURE(BM_BuiltSearch_CdcMap, avl_tree, cdc_map_avl));
+BUILD(BENCHMARK_CAPTURE(BM_BuiltSearch_CdcMap, treep, cdc_map_treap));
+BUILD(BENCHMARK_CAPTURE(BM_BuiltSearch_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_BuiltSearch_CdcAvlTree(benchmark::State &state)
+{
+  RunBuiltSearch<CdcAvlTreeMap>(state);
+}
+BUILD(BENCHMARK(BM_BuiltSearch_CdcAvlTree));
+
+template <class Map>
+static void BM_BuiltSearch_Typed(benchmark::State &state)
+{
+  RunBuiltSearch<TypedMap<Map>>(state);
+}
+BUILD(BENCHMARK_TEMPLATE(BM_BuiltSearch_Typed, TypedAvlTree<IntLess>));
+BUILD(BENCHMARK_TEMPLATE(BM_BuiltSearch_Typed, TypedTreap<IntLess>));
+BUILD(BENCHMARK_TEMPLATE(BM_BuiltSearch_Typed, TypedSplayTree<IntLess>));
+
+static void BM_BuiltSearch_BottomUpAvlTree(benchmark::State &state)
+{
+  RunBuiltSearch<BottomUpAvlTree>(state);
+}
+BUILD(BENCHMARK(BM_BuiltSearch_BottomUpAvlTree));
+
+// Ordered query benchmarks:
+// Maps hold the even keys 2, 4, ..., 2 * size inserted in random order, so odd
+// keys are never in the map and their bounds are their neighbours.
+// LowerBound looks up the bound of every missing key below the largest one,
+// UpperBound the successor of every key in the map.
+template <class Map, class... Args>
+static Map *MakeEvenMap(const RandomSet &rs, Args... args)
+{
+  auto map = new Map(args...);
+  rs.ForEach([=](auto v) { map->Insert(2 * v); });
+  return map;
+}
+
+template <class Map, class... Args>
+static void RunLowerBound(benchmark::State &state, Args... args)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  int bound = 0;
+  RunBatched(
+      state, [&] { return MakeEvenMap<Map>(rs, args...); },
+      [&](auto map) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(map->LowerBound(2 * v - 1, &bound));
+        });
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Map, class... Args>
+static void RunUpperBound(benchmark::State &state, Args... args)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  int bound = 0;
+  RunBatched(
+      state, [&] { return MakeEvenMap<Map>(rs, args...); },
+      [&](auto map) {
+        rs.ReverseForEach([&](auto v) {
+          benchmark::DoNotOptimize(map->UpperBound(2 * v, &bound));
+        });
+      },
+      [](auto map) { delete map; });
+}
+
+// Args are the size and the length of a scanned range in 1/10000 of the size,
+// from a single key to 10% of the map. As many ranges as the map holds keys are
+// scanned, which is quadratic in the size, so they keep the default sizes.
+static void RangeScanArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSmallSizes(benchmark, {1, 10, 100, 1000});
+}
+
+#define RANGE_SCAN(benchmark) \
+  benchmark->Apply(RangeScanArgs)->ArgNames({"", "sel"})->UseManualTime()
+
+// Scans ranges of `length` keys from random keys of the map until about as
+// many keys as the map holds are visited, so the time per key includes the
+// lookup of the first key of each range.
+template <class Map, class... Args>
+static void RunRangeScan(benchmark::State &state, Args... args)
+{
+  const auto size = static_cast<size_t>(state.range(0));
+  const auto length = std::max<size_t>(
+      1, size * static_cast<size_t>(state.range(1)) / 10000);
+  const RandomSet rs(size);
+  std::vector<int> from;
+  rs.ForEach([&](auto v) {
+    if (from.size() < size / length) {
+      from.push_back(2 * v);
+    }
+  });
+  const int span = static_cast<int>(2 * length);
+  RunBatched(
+      state, [&] { return MakeEvenMap<Map>(rs, args...); },
+      [&](auto map) {
+        int sum = 0;
+        for (auto key : from) {
+          map->Scan(key, key + span, [&](int k) { sum += k; });
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      [](auto map) { delete map; });
+}
+
+// Collections-C and the cdcontainers splay tree have no lookup of a missing
+// key's bound.
+static void BM_LowerBound_CppMap(benchmark::State &state)
+{
+  RunLowerBound<CppMap<std::map<int, void *>>>(state);
+}
+S(BENCHMARK(BM_LowerBound_CppMap));
+
+static void BM_LowerBound_GTree(benchmark::State &state)
+{
+  RunLowerBound<GTreeMap>(state);
+}
+S(BENCHMARK(BM_LowerBound_GTree));
+
+static void BM_LowerBound_CdcMap(benchmark::State &state,
+                                 const struct cdc_map_table *table)
+{
+  RunLowerBound<CdcMap>(state, table);
+}
+S(BENCHMARK_CAPTURE(BM_LowerBound_CdcMap, avl_tree, cdc_map_avl));
+S(BENCHMARK_CAPTURE(BM_LowerBound_CdcMap, treep, cdc_map_treap));
+
+static void BM_LowerBound_CdcAvlTree(benchmark::State &state)
+{
+  RunLowerBound<CdcAvlTreeMap>(state);
+}
+S(BENCHMARK(BM_LowerBound_CdcAvlTree));
+
+static void BM_UpperBound_CppMap(benchmark::State &state)
+{
+  RunUpperBound<CppMap<std::map<int, void *>>>(state);
+}
+S(BENCHMARK(BM_UpperBound_CppMap));
+
+static void BM_UpperBound_CcTreeTable(benchmark::State &state)
+{
+  RunUpperBound<CcTreeTableMap>(state);
+}
+S(BENCHMARK(BM_UpperBound_CcTreeTable));
+
+static void BM_UpperBound_GTree(benchmark::State &state)
+{
+  RunUpperBound<GTreeMap>(state);
+}
+S(BENCHMARK(BM_UpperBound_GTree));
+
+static void BM_UpperBound_CdcMap(benchmark::State &state,
+                                 const struct cdc_map_table *table)
+{
+  RunUpperBound<CdcMap>(state, table);
+}
+S(BENCHMARK_CAPTURE(BM_UpperBound_CdcMap, avl_tree, cdc_map_avl));
+S(BENCHMARK_CAPTURE(BM_UpperBound_CdcMap, treep, cdc_map_treap));
+S(BENCHMARK_CAPTURE(BM_UpperBound_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_UpperBound_CdcAvlTree(benchmark::State &state)
+{
+  RunUpperBound<CdcAvlTreeMap>(state);
+}
+S(BENCHMARK(BM_UpperBound_CdcAvlTree));
+
+static void BM_RangeScan_CppMap(benchmark::State &state)
+{
+  RunRangeScan<CppMap<std::map<int, void *>>>(state);
+}
+RANGE_SCAN(BENCHMARK(BM_RangeScan_CppMap));
+
+static void BM_RangeScan_CcTreeTable(benchmark::State &state)
+{
+  RunRangeScan<CcTreeTableMap>(state);
+}
+RANGE_SCAN(BENCHMARK(BM_RangeScan_CcTreeTable));
+
+static void BM_RangeScan_GTree(benchmark::State &state)
+{
+  RunRangeScan<GTreeMap>(state);
+}
+RANGE_SCAN(BENCHMARK(BM_RangeScan_GTree));
+
+static void BM_RangeScan_CdcMap(benchmark::State &state,
+                                const struct cdc_map_table *table)
+{
+  RunRangeScan<CdcMap>(state, table);
+}
+RANGE_SCAN(BENCHMARK_CAPTURE(BM_RangeScan_CdcMap, avl_tree, cdc_map_avl));
+RANGE_SCAN(BENCHMARK_CAPTURE(BM_RangeScan_CdcMap, treep, cdc_map_treap));
+RANGE_SCAN(BENCHMARK_CAPTURE(BM_RangeScan_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_RangeScan_CdcAvlTree(benchmark::State &state)
+{
+  RunRangeScan<CdcAvlTreeMap>(state);
+}
+RANGE_SCAN(BENCHMARK(BM_RangeScan_CdcAvlTree));
+
+// Skewed search benchmarks:
+// Every map holds the keys of RandomSet and looks up as many keys as it holds,
+// drawn from a Zipf distribution (exp:<exponent in hundredths>), a hot set
+// that moves through the keys (phases:<number of hot sets>) or bursts of one
+// key (burst:<lookups of a key in a row>).
+static void ZipfArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {50, 99, 120});
+}
+
+static void HotSetArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {1, 4, 16});
+}
+
+static void BurstArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {1, 4, 16});
+}
+
+#define ZIPF(benchmark) \
+  benchmark->Apply(ZipfArgs)->ArgNames({"", "exp"})->UseManualTime()
+#define HOT_SET(benchmark) \
+  benchmark->Apply(HotSetArgs)->ArgNames({"", "phases"})->UseManualTime()
+#define BURST(benchmark) \
+  benchmark->Apply(BurstArgs)->ArgNames({"", "burst"})->UseManualTime()
+
+template <class Map, class... Args>
+static void RunSkewed(benchmark::State &state, Skew skew, Args... args)
+{
+  const auto size = static_cast<size_t>(state.range(0));
+  const RandomSet rs(size);
+  const SkewedLookups lookups(size, size, skew, state.range(1));
+  RunBatched(
+      state,
+      [&] {
+        auto map = new Map(args...);
+        rs.ForEach([=](auto v) { map->Insert(v); });
+        return map;
+      },
+      [&](auto map) {
+        for (auto key : lookups) {
+          benchmark::DoNotOptimize(map->Find(key));
+        }
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Container>
+static void BM_ZipfSearch_Cpp(benchmark::State &state)
+{
+  RunSkewed<CppMap<Container>>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK_TEMPLATE(BM_ZipfSearch_Cpp, std::map<int, void *>));
+ZIPF(BENCHMARK_TEMPLATE(BM_ZipfSearch_Cpp, std::unordered_map<int, void *>));
+
+static void BM_ZipfSearch_CcHashTable(benchmark::State &state)
+{
+  RunSkewed<CcHashTableMap>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK(BM_ZipfSearch_CcHashTable));
+
+static void BM_ZipfSearch_CcTreeTable(benchmark::State &state)
+{
+  RunSkewed<CcTreeTableMap>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK(BM_ZipfSearch_CcTreeTable));
+
+static void BM_ZipfSearch_GTree(benchmark::State &state)
+{
+  RunSkewed<GTreeMap>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK(BM_ZipfSearch_GTree));
+
+static void BM_ZipfSearch_GHashTable(benchmark::State &state)
+{
+  RunSkewed<GHashTableMap>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK(BM_ZipfSearch_GHashTable));
+
+static void BM_ZipfSearch_CdcMap(benchmark::State &state,
+                                 const struct cdc_map_table *table)
+{
+  RunSkewed<CdcMap>(state, Skew::kZipf, table);
+}
+ZIPF(BENCHMARK_CAPTURE(BM_ZipfSearch_CdcMap, hash_table, cdc_map_htable));
+ZIPF(BENCHMARK_CAPTURE(BM_ZipfSearch_CdcMap, avl_tree, cdc_map_avl));
+ZIPF(BENCHMARK_CAPTURE(BM_ZipfSearch_CdcMap, treep, cdc_map_treap));
+ZIPF(BENCHMARK_CAPTURE(BM_ZipfSearch_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_ZipfSearch_CdcHashTable(benchmark::State &state)
+{
+  RunSkewed<CdcHashTableMap>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK(BM_ZipfSearch_CdcHashTable));
+
+static void BM_ZipfSearch_CdcAvlTree(benchmark::State &state)
+{
+  RunSkewed<CdcAvlTreeMap>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK(BM_ZipfSearch_CdcAvlTree));
+
+template <class Map>
+static void BM_ZipfSearch_Typed(benchmark::State &state)
+{
+  RunSkewed<TypedMap<Map>>(state, Skew::kZipf);
+}
+ZIPF(BENCHMARK_TEMPLATE(BM_ZipfSearch_Typed,
+                        TypedHashTable<IntHash, IntEqual>));
+ZIPF(BENCHMARK_TEMPLATE(BM_ZipfSearch_Typed, TypedAvlTree<IntLess>));
+ZIPF(BENCHMARK_TEMPLATE(BM_ZipfSearch_Typed, TypedTreap<IntLess>));
+ZIPF(BENCHMARK_TEMPLATE(BM_ZipfSearch_Typed, TypedSplayTree<IntLess>));
+
+template <class Container>
+static void BM_HotSetSearch_Cpp(benchmark::State &state)
+{
+  RunSkewed<CppMap<Container>>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK_TEMPLATE(BM_HotSetSearch_Cpp, std::map<int, void *>));
+HOT_SET(BENCHMARK_TEMPLATE(BM_HotSetSearch_Cpp,
+                           std::unordered_map<int, void *>));
+
+static void BM_HotSetSearch_CcHashTable(benchmark::State &state)
+{
+  RunSkewed<CcHashTableMap>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK(BM_HotSetSearch_CcHashTable));
+
+static void BM_HotSetSearch_CcTreeTable(benchmark::State &state)
+{
+  RunSkewed<CcTreeTableMap>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK(BM_HotSetSearch_CcTreeTable));
+
+static void BM_HotSetSearch_GTree(benchmark::State &state)
+{
+  RunSkewed<GTreeMap>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK(BM_HotSetSearch_GTree));
+
+static void BM_HotSetSearch_GHashTable(benchmark::State &state)
+{
+  RunSkewed<GHashTableMap>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK(BM_HotSetSearch_GHashTable));
+
+static void BM_HotSetSearch_CdcMap(benchmark::State &state,
+                                   const struct cdc_map_table *table)
+{
+  RunSkewed<CdcMap>(state, Skew::kHotSet, table);
+}
+HOT_SET(BENCHMARK_CAPTURE(BM_HotSetSearch_CdcMap, hash_table, cdc_map_htable));
+HOT_SET(BENCHMARK_CAPTURE(BM_HotSetSearch_CdcMap, avl_tree, cdc_map_avl));
+HOT_SET(BENCHMARK_CAPTURE(BM_HotSetSearch_CdcMap, treep, cdc_map_treap));
+HOT_SET(BENCHMARK_CAPTURE(BM_HotSetSearch_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_HotSetSearch_CdcHashTable(benchmark::State &state)
+{
+  RunSkewed<CdcHashTableMap>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK(BM_HotSetSearch_CdcHashTable));
+
+static void BM_HotSetSearch_CdcAvlTree(benchmark::State &state)
+{
+  RunSkewed<CdcAvlTreeMap>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK(BM_HotSetSearch_CdcAvlTree));
+
+template <class Map>
+static void BM_HotSetSearch_Typed(benchmark::State &state)
+{
+  RunSkewed<TypedMap<Map>>(state, Skew::kHotSet);
+}
+HOT_SET(BENCHMARK_TEMPLATE(BM_HotSetSearch_Typed,
+                           TypedHashTable<IntHash, IntEqual>));
+HOT_SET(BENCHMARK_TEMPLATE(BM_HotSetSearch_Typed, TypedAvlTree<IntLess>));
+HOT_SET(BENCHMARK_TEMPLATE(BM_HotSetSearch_Typed, TypedTreap<IntLess>));
+HOT_SET(BENCHMARK_TEMPLATE(BM_HotSetSearch_Typed, TypedSplayTree<IntLess>));
+
+template <class Container>
+static void BM_BurstSearch_Cpp(benchmark::State &state)
+{
+  RunSkewed<CppMap<Container>>(state, Skew::kBurst);
+}
+BURST(BENCHMARK_TEMPLATE(BM_BurstSearch_Cpp, std::map<int, void *>));
+BURST(BENCHMARK_TEMPLATE(BM_BurstSearch_Cpp, std::unordered_map<int, void *>));
+
+static void BM_BurstSearch_CcHashTable(benchmark::State &state)
+{
+  RunSkewed<CcHashTableMap>(state, Skew::kBurst);
+}
+BURST(BENCHMARK(BM_BurstSearch_CcHashTable));
+
+static void BM_BurstSearch_CcTreeTable(benchmark::State &state)
+{
+  RunSkewed<CcTreeTableMap>(state, Skew::kBurst);
+}
+BURST(BENCHMARK(BM_BurstSearch_CcTreeTable));
+
+static void BM_BurstSearch_GTree(benchmark::State &state)
+{
+  RunSkewed<GTreeMap>(state, Skew::kBurst);
+}
+BURST(BENCHMARK(BM_BurstSearch_GTree));
+
+static void BM_BurstSearch_GHashTable(benchmark::State &state)
+{
+  RunSkewed<GHashTableMap>(state, Skew::kBurst);
+}
+BURST(BENCHMARK(BM_BurstSearch_GHashTable));
+
+static void BM_BurstSearch_CdcMap(benchmark::State &state,
+                                  const struct cdc_map_table *table)
+{
+  RunSkewed<CdcMap>(state, Skew::kBurst, table);
+}
+BURST(BENCHMARK_CAPTURE(BM_BurstSearch_CdcMap, hash_table, cdc_map_htable));
+BURST(BENCHMARK_CAPTURE(BM_BurstSearch_CdcMap, avl_tree, cdc_map_avl));
+BURST(BENCHMARK_CAPTURE(BM_BurstSearch_CdcMap, treep, cdc_map_treap));
+BURST(BENCHMARK_CAPTURE(BM_BurstSearch_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_BurstSearch_CdcHashTable(benchmark::State &state)
+{
+  RunSkewed<CdcHashTableMap>(state, Skew::kBurst);
+}
+BURST(BENCHMARK(BM_BurstSearch_CdcHashTable));
+
+static void BM_BurstSearch_CdcAvlTree(benchmark::State &state)
+{
+  RunSkewed<CdcAvlTreeMap>(state, Skew::kBurst);
+}
+BURST(BENCHMARK(BM_BurstSearch_CdcAvlTree));
+
+template <class Map>
+static void BM_BurstSearch_Typed(benchmark::State &state)
+{
+  RunSkewed<TypedMap<Map>>(state, Skew::kBurst);
+}
+BURST(BENCHMARK_TEMPLATE(BM_BurstSearch_Typed,
+                         TypedHashTable<IntHash, IntEqual>));
+BURST(BENCHMARK_TEMPLATE(BM_BurstSearch_Typed, TypedAvlTree<IntLess>));
+BURST(BENCHMARK_TEMPLATE(BM_BurstSearch_Typed, TypedTreap<IntLess>));
+BURST(BENCHMARK_TEMPLATE(BM_BurstSearch_Typed, TypedSplayTree<IntLess>));
+
+// Load factor benchmarks:
+// Args are the size and the max load factor in percent (0 keeps the default of
+// the library). LoadFactorInsert and LoadFactorSearch grow tables from empty,
+// ReservedInsert makes room for all keys up front. Sizes are those of
+// AddSizes, so with BENCH_LARGE_N tables grow to 1 << 26 keys and rehash far
+// out of the LLC.
+static void LoadFactorArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {0, 50, 100, 200, 400});
+}
+
+// GHashTable sizes itself, so it only runs with lf:0.
+static void DefaultLoadFactorArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {0});
+}
+
+#define LOAD_FACTOR(benchmark) \
+  benchmark->Apply(LoadFactorArgs)->ArgNames({"", "lf"})->UseManualTime()
+#define DEFAULT_LOAD_FACTOR(benchmark)    \
+  benchmark->Apply(DefaultLoadFactorArgs) \
+      ->ArgNames({"", "lf"})              \
+      ->UseManualTime()
+
+template <class Map>
+static Map *NewHashTable(const benchmark::State &state, bool reserve)
+{
+  return new Map(static_cast<float>(state.range(1)) / 100.0f,
+                 reserve ? static_cast<size_t>(state.range(0)) : 0);
+}
+
+template <>
+GHashTableMap *NewHashTable<GHashTableMap>(const benchmark::State &, bool)
+{
+  return new GHashTableMap;
+}
+
+template <class Map>
+static void RunLoadFactorInsert(benchmark::State &state, bool reserve)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewHashTable<Map>(state, reserve); },
+      [&](auto map) {
+        for (auto key : keys) {
+          map->Insert(key);
+        }
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Map>
+static void RunLoadFactorSearch(benchmark::State &state)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        auto map = NewHashTable<Map>(state, false);
+        rs.ForEach([=](auto v) { map->Insert(v); });
+        return map;
+      },
+      [&](auto map) {
+        rs.ReverseForEach(
+            [&](auto v) { benchmark::DoNotOptimize(map->Find(v)); });
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Container>
+static void BM_LoadFactorInsert_Cpp(benchmark::State &state)
+{
+  RunLoadFactorInsert<CppMap<Container>>(state, false);
+}
+LOAD_FACTOR(BENCHMARK_TEMPLATE(BM_LoadFactorInsert_Cpp,
+                               std::unordered_map<int, void *>));
+
+static void BM_LoadFactorInsert_CcHashTable(benchmark::State &state)
+{
+  RunLoadFactorInsert<CcHashTableMap>(state, false);
+}
+LOAD_FACTOR(BENCHMARK(BM_LoadFactorInsert_CcHashTable));
+
+static void BM_LoadFactorInsert_GHashTable(benchmark::State &state)
+{
+  RunLoadFactorInsert<GHashTableMap>(state, false);
+}
+DEFAULT_LOAD_FACTOR(BENCHMARK(BM_LoadFactorInsert_GHashTable));
+
+static void BM_LoadFactorInsert_CdcHashTable(benchmark::State &state)
+{
+  RunLoadFactorInsert<CdcHashTableMap>(state, false);
+}
+LOAD_FACTOR(BENCHMARK(BM_LoadFactorInsert_CdcHashTable));
+
+template <class Container>
+static void BM_ReservedInsert_Cpp(benchmark::State &state)
+{
+  RunLoadFactorInsert<CppMap<Container>>(state, true);
+}
+LOAD_FACTOR(BENCHMARK_TEMPLATE(BM_ReservedInsert_Cpp,
+                               std::unordered_map<int, void *>));
+
+static void BM_ReservedInsert_CcHashTable(benchmark::State &state)
+{
+  RunLoadFactorInsert<CcHashTableMap>(state, true);
+}
+LOAD_FACTOR(BENCHMARK(BM_ReservedInsert_CcHashTable));
+
+static void BM_ReservedInsert_CdcHashTable(benchmark::State &state)
+{
+  RunLoadFactorInsert<CdcHashTableMap>(state, true);
+}
+LOAD_FACTOR(BENCHMARK(BM_ReservedInsert_CdcHashTable));
+
+template <class Container>
+static void BM_LoadFactorSearch_Cpp(benchmark::State &state)
+{
+  RunLoadFactorSearch<CppMap<Container>>(state);
+}
+LOAD_FACTOR(BENCHMARK_TEMPLATE(BM_LoadFactorSearch_Cpp,
+                               std::unordered_map<int, void *>));
+
+static void BM_LoadFactorSearch_CcHashTable(benchmark::State &state)
+{
+  RunLoadFactorSearch<CcHashTableMap>(state);
+}
+LOAD_FACTOR(BENCHMARK(BM_LoadFactorSearch_CcHashTable));
+
+static void BM_LoadFactorSearch_GHashTable(benchmark::State &state)
+{
+  RunLoadFactorSearch<GHashTableMap>(state);
+}
+DEFAULT_LOAD_FACTOR(BENCHMARK(BM_LoadFactorSearch_GHashTable));
+
+static void BM_LoadFactorSearch_CdcHashTable(benchmark::State &state)
+{
+  RunLoadFactorSearch<CdcHashTableMap>(state);
+}
+LOAD_FACTOR(BENCHMARK(BM_LoadFactorSearch_CdcHashTable));
+
+// Rehash benchmarks:
+// Args are the size and the max load factor in percent. Tables grow from empty
+// and every insert is timed on its own: rehashes is the number of inserts that
+// changed the bucket count per table, rehash_ns their average and
+// max_rehash_ns the slowest of them. The time includes the clock reads around
+// every insert. GHashTable does not expose its size, so it is not here. With
+// BENCH_LARGE_N, tables grow to 1 << 26 keys as in the load factor benchmarks.
+static void RehashArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {0, 50, 100, 200, 400});
+}
+
+#define REHASH(benchmark) \
+  benchmark->Apply(RehashArgs)->ArgNames({"", "lf"})->UseManualTime()
+
+template <class Map>
+static void RunRehash(benchmark::State &state)
+{
+  using Clock = std::chrono::steady_clock;
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const float load_factor = static_cast<float>(state.range(1)) / 100.0f;
+  size_t rehashes = 0;
+  double rehash_time = 0;
+  double max_rehash_time = 0;
+  for (auto _ : state) {
+    Map map(load_factor, 0);
+    size_t buckets = map.BucketCount();
+    double time = 0;
+    for (auto key : keys) {
+      const auto start = Clock::now();
+      map.Insert(key);
+      const auto end = Clock::now();
+      const double elapsed = std::chrono::duration<double>(end - start).count();
+      time += elapsed;
+      if (map.BucketCount() != buckets) {
+        buckets = map.BucketCount();
+        ++rehashes;
+        rehash_time += elapsed;
+        max_rehash_time = std::max(max_rehash_time, elapsed);
+      }
+    }
+    state.SetIterationTime(time);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["rehashes"] = static_cast<double>(rehashes) /
+                               static_cast<double>(state.iterations());
+  state.counters["rehash_ns"] =
+      rehashes != 0 ? rehash_time * 1e9 / static_cast<double>(rehashes) : 0;
+  state.counters["max_rehash_ns"] = max_rehash_time * 1e9;
+}
+
+template <class Container>
+static void BM_Rehash_Cpp(benchmark::State &state)
+{
+  RunRehash<CppMap<Container>>(state);
+}
+REHASH(BENCHMARK_TEMPLATE(BM_Rehash_Cpp, std::unordered_map<int, void *>));
+
+static void BM_Rehash_CcHashTable(benchmark::State &state)
+{
+  RunRehash<CcHashTableMap>(state);
+}
+REHASH(BENCHMARK(BM_Rehash_CcHashTable));
+
+static void BM_Rehash_CdcHashTable(benchmark::State &state)
+{
+  RunRehash<CdcHashTableMap>(state);
+}
+REHASH(BENCHMARK(BM_Rehash_CdcHashTable));
+
+// Hit ratio search benchmarks:
+// Args are the size and the percent of lookups that find their key (hit:0 only
+// misses). Maps hold the even keys as in the ordered query benchmarks, missed
+// keys are odd keys between them. plot.py draws these as series of the Search
+// graph.
+static void HitSearchArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {0, 50});
+}
+
+#define HIT_SEARCH(benchmark) \
+  benchmark->Apply(HitSearchArgs)->ArgNames({"", "hit"})->UseManualTime()
+
+template <class Map, class... Args>
+static void RunHitSearch(benchmark::State &state, Args... args)
+{
+  const auto size = static_cast<size_t>(state.range(0));
+  const RandomSet rs(size);
+  const auto lookups = HitRatioLookups(size, size, state.range(1));
+  RunBatched(
+      state, [&] { return MakeEvenMap<Map>(rs, args...); },
+      [&](auto map) {
+        for (auto key : lookups) {
+          benchmark::DoNotOptimize(map->Find(key));
+        }
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Container>
+static void BM_HitSearch_Cpp(benchmark::State &state)
+{
+  RunHitSearch<CppMap<Container>>(state);
+}
+HIT_SEARCH(BENCHMARK_TEMPLATE(BM_HitSearch_Cpp, std::map<int, void *>));
+HIT_SEARCH(BENCHMARK_TEMPLATE(BM_HitSearch_Cpp,
+                              std::unordered_map<int, void *>));
+
+static void BM_HitSearch_CcHashTable(benchmark::State &state)
+{
+  RunHitSearch<CcHashTableMap>(state);
+}
+HIT_SEARCH(BENCHMARK(BM_HitSearch_CcHashTable));
+
+static void BM_HitSearch_CcTreeTable(benchmark::State &state)
+{
+  RunHitSearch<CcTreeTableMap>(state);
+}
+HIT_SEARCH(BENCHMARK(BM_HitSearch_CcTreeTable));
+
+static void BM_HitSearch_GTree(benchmark::State &state)
+{
+  RunHitSearch<GTreeMap>(state);
+}
+HIT_SEARCH(BENCHMARK(BM_HitSearch_GTree));
+
+static void BM_HitSearch_GHashTable(benchmark::State &state)
+{
+  RunHitSearch<GHashTableMap>(state);
+}
+HIT_SEARCH(BENCHMARK(BM_HitSearch_GHashTable));
+
+static void BM_HitSearch_CdcMap(benchmark::State &state,
+                                const struct cdc_map_table *table)
+{
+  RunHitSearch<CdcMap>(state, table);
+}
+HIT_SEARCH(BENCHMARK_CAPTURE(BM_HitSearch_CdcMap, hash_table, cdc_map_htable));
+HIT_SEARCH(BENCHMARK_CAPTURE(BM_HitSearch_CdcMap, avl_tree, cdc_map_avl));
+HIT_SEARCH(BENCHMARK_CAPTURE(BM_HitSearch_CdcMap, treep, cdc_map_treap));
+HIT_SEARCH(BENCHMARK_CAPTURE(BM_HitSearch_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_HitSearch_CdcHashTable(benchmark::State &state)
+{
+  RunHitSearch<CdcHashTableMap>(state);
+}
+HIT_SEARCH(BENCHMARK(BM_HitSearch_CdcHashTable));
+
+static void BM_HitSearch_CdcAvlTree(benchmark::State &state)
+{
+  RunHitSearch<CdcAvlTreeMap>(state);
+}
+HIT_SEARCH(BENCHMARK(BM_HitSearch_CdcAvlTree));
+
+template <class Map>
+static void BM_HitSearch_Typed(benchmark::State &state)
+{
+  RunHitSearch<TypedMap<Map>>(state);
+}
+HIT_SEARCH(BENCHMARK_TEMPLATE(BM_HitSearch_Typed,
+                              TypedHashTable<IntHash, IntEqual>));
+HIT_SEARCH(BENCHMARK_TEMPLATE(BM_HitSearch_Typed, TypedAvlTree<IntLess>));
+HIT_SEARCH(BENCHMARK_TEMPLATE(BM_HitSearch_Typed, TypedTreap<IntLess>));
+HIT_SEARCH(BENCHMARK_TEMPLATE(BM_HitSearch_Typed, TypedSplayTree<IntLess>));
+
+// Aged map benchmarks:
+// Args are the size and rounds of churn: before the timed part, the map is
+// filled in key order, then erases a random half of its keys and inserts as
+// many others `churn` times (churn:0 is a fresh map). Each insert of the churn
+// is followed by a short-lived allocation of another size, freed when the
+// next batch of erases starts, as other data of a program would be; otherwise
+// the allocator hands the freed nodes back in order and the aged map is laid
+// out as a fresh one. Nodes of an aged map are scattered over the heap, as in
+// maps that have lived long, rather than allocated one after another, which
+// AgedTraversal shows as a drop from churn:0. Aging costs many times the timed
+// part, so the maps are aged once and reused by every batch; splay trees still
+// reshape on lookups, but keep their aged nodes.
+static void AgedArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {0, 1, 8});
+}
+
+#define AGED(benchmark) \
+  benchmark->Apply(AgedArgs)->ArgNames({"", "churn"})->UseManualTime()
+
+template <class Map, class... Args>
+static Map *MakeAgedMap(const AgingWorkload &workload, Args... args)
+{
+  auto map = new Map(args...);
+  for (auto key : workload.Resident()) {
+    map->Insert(key);
+  }
+
+  std::vector<void *> ballast;
+  ballast.reserve(workload.Resident().size());
+  auto free_ballast = [&] {
+    for (auto ptr : ballast) {
+      std::free(ptr);
+    }
+    ballast.clear();
+  };
+  for (const auto &op : workload.Churn()) {
+    if (op.op == MapOp::kInsert) {
+      map->Insert(op.key);
+      ballast.push_back(std::malloc(16 * (1 + op.key % 8)));
+    } else {
+      free_ballast();
+      map->Erase(op.key);
+    }
+  }
+  free_ballast();
+  return map;
+}
+
+template <class Map, class... Args>
+static void RunAgedTraversal(benchmark::State &state, Args... args)
+{
+  const AgingWorkload workload(static_cast<size_t>(state.range(0)),
+                               static_cast<size_t>(state.range(1)));
+  RunReused(
+      state, [&] { return MakeAgedMap<Map>(workload, args...); },
+      [](auto map) {
+        map->ForEach([](auto key) { benchmark::DoNotOptimize(key); });
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Map, class... Args>
+static void RunAgedSearch(benchmark::State &state, Args... args)
+{
+  const AgingWorkload workload(static_cast<size_t>(state.range(0)),
+                               static_cast<size_t>(state.range(1)));
+  RunReused(
+      state, [&] { return MakeAgedMap<Map>(workload, args...); },
+      [&](auto map) {
+        for (auto key : workload.Aged()) {
+          benchmark::DoNotOptimize(map->Find(key));
+        }
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Container>
+static void BM_AgedTraversal_Cpp(benchmark::State &state)
+{
+  RunAgedTraversal<CppMap<Container>>(state);
+}
+AGED(BENCHMARK_TEMPLATE(BM_AgedTraversal_Cpp, std::map<int, void *>));
+AGED(BENCHMARK_TEMPLATE(BM_AgedTraversal_Cpp, std::unordered_map<int, void *>));
+
+static void BM_AgedTraversal_CcHashTable(benchmark::State &state)
+{
+  RunAgedTraversal<CcHashTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedTraversal_CcHashTable));
+
+static void BM_AgedTraversal_CcTreeTable(benchmark::State &state)
+{
+  RunAgedTraversal<CcTreeTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedTraversal_CcTreeTable));
+
+static void BM_AgedTraversal_GTree(benchmark::State &state)
+{
+  RunAgedTraversal<GTreeMap>(state);
+}
+AGED(BENCHMARK(BM_AgedTraversal_GTree));
+
+static void BM_AgedTraversal_GHashTable(benchmark::State &state)
+{
+  RunAgedTraversal<GHashTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedTraversal_GHashTable));
+
+static void BM_AgedTraversal_CdcMap(benchmark::State &state,
+                                    const struct cdc_map_table *table)
+{
+  RunAgedTraversal<CdcMap>(state, table);
+}
+AGED(BENCHMARK_CAPTURE(BM_AgedTraversal_CdcMap, hash_table, cdc_map_htable));
+AGED(BENCHMARK_CAPTURE(BM_AgedTraversal_CdcMap, avl_tree, cdc_map_avl));
+AGED(BENCHMARK_CAPTURE(BM_AgedTraversal_CdcMap, treep, cdc_map_treap));
+AGED(BENCHMARK_CAPTURE(BM_AgedTraversal_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_AgedTraversal_CdcHashTable(benchmark::State &state)
+{
+  RunAgedTraversal<CdcHashTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedTraversal_CdcHashTable));
+
+static void BM_AgedTraversal_CdcAvlTree(benchmark::State &state)
+{
+  RunAgedTraversal<CdcAvlTreeMap>(state);
+}
+AGED(BENCHMARK(BM_AgedTraversal_CdcAvlTree));
+
+template <class Container>
+static void BM_AgedSearch_Cpp(benchmark::State &state)
+{
+  RunAgedSearch<CppMap<Container>>(state);
+}
+AGED(BENCHMARK_TEMPLATE(BM_AgedSearch_Cpp, std::map<int, void *>));
+AGED(BENCHMARK_TEMPLATE(BM_AgedSearch_Cpp, std::unordered_map<int, void *>));
+
+static void BM_AgedSearch_CcHashTable(benchmark::State &state)
+{
+  RunAgedSearch<CcHashTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedSearch_CcHashTable));
+
+static void BM_AgedSearch_CcTreeTable(benchmark::State &state)
+{
+  RunAgedSearch<CcTreeTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedSearch_CcTreeTable));
+
+static void BM_AgedSearch_GTree(benchmark::State &state)
+{
+  RunAgedSearch<GTreeMap>(state);
+}
+AGED(BENCHMARK(BM_AgedSearch_GTree));
+
+static void BM_AgedSearch_GHashTable(benchmark::State &state)
+{
+  RunAgedSearch<GHashTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedSearch_GHashTable));
+
+static void BM_AgedSearch_CdcMap(benchmark::State &state,
+                                 const struct cdc_map_table *table)
+{
+  RunAgedSearch<CdcMap>(state, table);
+}
+AGED(BENCHMARK_CAPTURE(BM_AgedSearch_CdcMap, hash_table, cdc_map_htable));
+AGED(BENCHMARK_CAPTURE(BM_AgedSearch_CdcMap, avl_tree, cdc_map_avl));
+AGED(BENCHMARK_CAPTURE(BM_AgedSearch_CdcMap, treep, cdc_map_treap));
+AGED(BENCHMARK_CAPTURE(BM_AgedSearch_CdcMap, splay_tree, cdc_map_splay));
+
+static void BM_AgedSearch_CdcHashTable(benchmark::State &state)
+{
+  RunAgedSearch<CdcHashTableMap>(state);
+}
+AGED(BENCHMARK(BM_AgedSearch_CdcHashTable));
+
+static void BM_AgedSearch_CdcAvlTree(benchmark::State &state)
+{
+  RunAgedSearch<CdcAvlTreeMap>(state);
+}
+AGED(BENCHMARK(BM_AgedSearch_CdcAvlTree));
+
+// Latency benchmarks:
+// Insert and Search with every operation timed on its own, for the p50, p90,
+// p99, p99.9 and max latency counters: rehashes of the hash tables and splay
+// tree restructuring show in the tail rather than in the mean.
+template <class Map, class... Args>
+static void RunInsertLatency(benchmark::State &state, Args... args)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunSampled(
+      state, [&] { return new Map(args...); },
+      [&](auto map, size_t i) { map->Insert(keys[i]); },
+      [](auto map) { delete map; });
+}
+
+template <class Map, class... Args>
+static void RunSearchLatency(benchmark::State &state, Args... args)
+{
+  const auto size = static_cast<size_t>(state.range(0));
+  const RandomSet rs(size);
+  const auto lookups = HitRatioLookups(size, size, 100);
+  RunSampled(
+      state, [&] { return MakeEvenMap<Map>(rs, args...); },
+      [&](auto map, size_t i) {
+        benchmark::DoNotOptimize(map->Find(lookups[i]));
+      },
+      [](auto map) { delete map; });
+}
+
+template <class Container>
+static void BM_InsertLatency_Cpp(benchmark::State &state)
+{
+  RunInsertLatency<CppMap<Container>>(state);
+}
+S_LATENCY(BENCHMARK_TEMPLATE(BM_InsertLatency_Cpp, std::map<int, void *>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_InsertLatency_Cpp,
+                             std::unordered_map<int, void *>));
+
+static void BM_InsertLatency_CcHashTable(benchmark::State &state)
+{
+  RunInsertLatency<CcHashTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_InsertLatency_CcHashTable));
+
+static void BM_InsertLatency_CcTreeTable(benchmark::State &state)
+{
+  RunInsertLatency<CcTreeTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_InsertLatency_CcTreeTable));
+
+static void BM_InsertLatency_GTree(benchmark::State &state)
+{
+  RunInsertLatency<GTreeMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_InsertLatency_GTree));
+
+static void BM_InsertLatency_GHashTable(benchmark::State &state)
+{
+  RunInsertLatency<GHashTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_InsertLatency_GHashTable));
+
+static void BM_InsertLatency_CdcMap(benchmark::State &state,
+                                    const struct cdc_map_table *table)
+{
+  RunInsertLatency<CdcMap>(state, table);
+}
+S_LATENCY(BENCHMARK_CAPTURE(BM_InsertLatency_CdcMap, hash_table,
+                            cdc_map_htable));
+S_LATENCY(BENCHMARK_CAPTURE(BM_InsertLatency_CdcMap, avl_tree, cdc_map_avl));
+S_LATENCY(BENCHMARK_CAPTURE(BM_InsertLatency_CdcMap, treep, cdc_map_treap));
+S_LATENCY(BENCHMARK_CAPTURE(BM_InsertLatency_CdcMap, splay_tree,
+                            cdc_map_splay));
+
+static void BM_InsertLatency_CdcHashTable(benchmark::State &state)
+{
+  RunInsertLatency<CdcHashTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_InsertLatency_CdcHashTable));
+
+static void BM_InsertLatency_CdcAvlTree(benchmark::State &state)
+{
+  RunInsertLatency<CdcAvlTreeMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_InsertLatency_CdcAvlTree));
+
+template <class Map>
+static void BM_InsertLatency_Typed(benchmark::State &state)
+{
+  RunInsertLatency<TypedMap<Map>>(state);
+}
+S_LATENCY(BENCHMARK_TEMPLATE(BM_InsertLatency_Typed,
+                             TypedHashTable<IntHash, IntEqual>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_InsertLatency_Typed, TypedAvlTree<IntLess>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_InsertLatency_Typed, TypedTreap<IntLess>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_InsertLatency_Typed, TypedSplayTree<IntLess>));
+
+template <class Container>
+static void BM_SearchLatency_Cpp(benchmark::State &state)
+{
+  RunSearchLatency<CppMap<Container>>(state);
+}
+S_LATENCY(BENCHMARK_TEMPLATE(BM_SearchLatency_Cpp, std::map<int, void *>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_SearchLatency_Cpp,
+                             std::unordered_map<int, void *>));
+
+static void BM_SearchLatency_CcHashTable(benchmark::State &state)
+{
+  RunSearchLatency<CcHashTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_SearchLatency_CcHashTable));
+
+static void BM_SearchLatency_CcTreeTable(benchmark::State &state)
+{
+  RunSearchLatency<CcTreeTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_SearchLatency_CcTreeTable));
+
+static void BM_SearchLatency_GTree(benchmark::State &state)
+{
+  RunSearchLatency<GTreeMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_SearchLatency_GTree));
+
+static void BM_SearchLatency_GHashTable(benchmark::State &state)
+{
+  RunSearchLatency<GHashTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_SearchLatency_GHashTable));
+
+static void BM_SearchLatency_CdcMap(benchmark::State &state,
+                                    const struct cdc_map_table *table)
+{
+  RunSearchLatency<CdcMap>(state, table);
+}
+S_LATENCY(BENCHMARK_CAPTURE(BM_SearchLatency_CdcMap, hash_table,
+                            cdc_map_htable));
+S_LATENCY(BENCHMARK_CAPTURE(BM_SearchLatency_CdcMap, avl_tree, cdc_map_avl));
+S_LATENCY(BENCHMARK_CAPTURE(BM_SearchLatency_CdcMap, treep, cdc_map_treap));
+S_LATENCY(BENCHMARK_CAPTURE(BM_SearchLatency_CdcMap, splay_tree,
+                            cdc_map_splay));
+
+static void BM_SearchLatency_CdcHashTable(benchmark::State &state)
+{
+  RunSearchLatency<CdcHashTableMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_SearchLatency_CdcHashTable));
+
+static void BM_SearchLatency_CdcAvlTree(benchmark::State &state)
+{
+  RunSearchLatency<CdcAvlTreeMap>(state);
+}
+S_LATENCY(BENCHMARK(BM_SearchLatency_CdcAvlTree));
+
+template <class Map>
+static void BM_SearchLatency_Typed(benchmark::State &state)
+{
+  RunSearchLatency<TypedMap<Map>>(state);
+}
+S_LATENCY(BENCHMARK_TEMPLATE(BM_SearchLatency_Typed,
+                             TypedHashTable<IntHash, IntEqual>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_SearchLatency_Typed, TypedAvlTree<IntLess>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_SearchLatency_Typed, TypedTreap<IntLess>));
+S_LATENCY(BENCHMARK_TEMPLATE(BM_SearchLatency_Typed, TypedSplayTree<IntLess>));
+
+// Interleaved search benchmarks:
+// Args are the size and the number of lookups in flight (group:1 runs one at
+// a time through the same engine). Every map holds the keys of RandomSet and
+// looks all of them up as Search does, with the lookups of interleaved.hpp
+// that prefetch their next node and switch to another lookup meanwhile.
+static void InterleavedArgs(benchmark::internal::Benchmark *benchmark)
+{
+  AddSizes(benchmark, {1, 2, 4, 8, 16, 32});
+}
+
+#define INTERLEAVED(benchmark) \
+  benchmark->Apply(InterleavedArgs)->ArgNames({"", "group"})->UseManualTime()
+
+template <class Cursor, class Ctor, class Dtor>
+static void RunInterleaved(benchmark::State &state, const RandomSet &rs,
+                           Ctor &&ctor, Dtor &&dtor)
+{
+  std::vector<int> keys;
+  rs.ReverseForEach([&](auto v) { keys.push_back(v); });
+  const auto group = static_cast<size_t>(state.range(1));
+  RunBatched(
+      state, ctor,
+      [&](auto map) {
+        benchmark::DoNotOptimize(
+            InterleavedFind<Cursor>(map, keys.data(), keys.size(), group));
+      },
+      dtor);
+}
+
+static void BM_InterleavedSearch_CppUnorderedMap(benchmark::State &state)
+{
+  using Map = std::unordered_map<int, void *>;
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  RunInterleaved<CppUnorderedMapCursor<Map>>(
+      state, rs,
+      [&] {
+        auto map = new Map;
+        rs.ForEach([=](auto v) { map->emplace(v, nullptr); });
+        return map;
+      },
+      [](auto map) { delete map; });
+}
+INTERLEAVED(BENCHMARK(BM_InterleavedSearch_CppUnorderedMap));
+
+static void BM_InterleavedSearch_CdcHashTable(benchmark::State &state)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  struct cdc_data_info info = {};
+  info.eq = IsEquil;
+  info.hash = Hash;
+  RunInterleaved<CdcHashTableCursor>(
+      state, rs,
+      [&] {
+        struct cdc_hash_table *map = nullptr;
+        cdc_hash_table_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_hash_table_insert(map, CDC_FROM_INT(v), nullptr, nullptr,
+                                nullptr);
+        });
+        return map;
+      },
+      cdc_hash_table_dtor);
+}
+INTERLEAVED(BENCHMARK(BM_InterleavedSearch_CdcHashTable));
+
+static void BM_InterleavedSearch_CdcAvlTree(benchmark::State &state)
+{
+  const RandomSet rs(static_cast<size_t>(state.range(0)));
+  struct cdc_data_info info = {};
+  info.cmp = Less;
+  RunInterleaved<CdcAvlTreeCursor>(
+      state, rs,
+      [&] {
+        struct cdc_avl_tree *map = nullptr;
+        cdc_avl_tree_ctor(&map, &info);
+        rs.ForEach([=](auto v) {
+          cdc_avl_tree_insert1(map, CDC_FROM_INT(v), nullptr, nullptr, nullptr);
+        });
+        return map;
+      },
+      cdc_avl_tree_dtor);
+}
+INTERLEAVED(BENCHMARK(BM_InterleavedSearch_CdcAvlTree));
+
+BENCH_MAIN();
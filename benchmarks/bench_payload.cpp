@@ -0,0 +1,566 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+extern "C" {
+#include <cdcontainers/cdc.h>
+#include <collectc/deque.h>
+#include <collectc/list.h>
+#include <gmodule.h>
+}
+
+#include <benchmark/benchmark.h>
+
+#include "benchmarks/payload.hpp"
+#include "benchmarks/utils.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Args are the number of elements and the sizes of keys and values in bytes:
+// 16 and 64 byte string keys without values, and int keys with 64 and 256
+// byte values. Numbers of elements are those of Sizes().
+static void PayloadArgs(benchmark::internal::Benchmark *benchmark)
+{
+  const int64_t payloads[][2] = {{16, 0}, {64, 0}, {0, 64}, {0, 256}};
+  for (const auto &payload : payloads) {
+    for (auto n : Sizes()) {
+      benchmark->Args({n, payload[0], payload[1]});
+    }
+  }
+}
+
+#define P(benchmark)                                                      \
+  benchmark->Apply(PayloadArgs)->ArgNames({"", "key", "value"})->UseManualTime()
+
+static Payload MakePayload(const benchmark::State &state)
+{
+  return Payload(static_cast<size_t>(state.range(0)),
+                 static_cast<size_t>(state.range(1)),
+                 static_cast<size_t>(state.range(2)));
+}
+
+// Standard containers hold keys as std::string or int and own values through
+// std::unique_ptr.
+template <size_t Size>
+struct Blob {
+  char data[Size];
+};
+
+template <class T>
+struct Tag {
+  using type = T;
+};
+
+// Calls fn(key tag, value tag) with the types of the payload.
+template <class Fn>
+static void DispatchPayload(const Payload &payload, Fn &&fn)
+{
+  if (payload.StringKeys()) {
+    fn(Tag<std::string>(), Tag<void *>());
+  } else if (payload.ValueSize() <= 64) {
+    fn(Tag<int>(), Tag<std::unique_ptr<Blob<64>>>());
+  } else {
+    fn(Tag<int>(), Tag<std::unique_ptr<Blob<256>>>());
+  }
+}
+
+static std::vector<int> MakeKeys(Tag<int>, const Payload &payload)
+{
+  std::vector<int> keys;
+  for (size_t i = 0; i < payload.Size(); ++i) {
+    keys.push_back(payload.IntKey(i));
+  }
+  return keys;
+}
+
+static std::vector<std::string> MakeKeys(Tag<std::string>,
+                                         const Payload &payload)
+{
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < payload.Size(); ++i) {
+    keys.emplace_back(payload.StringKey(i));
+  }
+  return keys;
+}
+
+static void *MakeValue(Tag<void *>, const Payload &, size_t) { return nullptr; }
+
+template <class T>
+static std::unique_ptr<T> MakeValue(Tag<std::unique_ptr<T>>,
+                                    const Payload &payload, size_t i)
+{
+  std::unique_ptr<T> value(new T);
+  std::memset(value.get(), payload.IntKey(i), sizeof(T));
+  return value;
+}
+
+// Insert benchmarks:
+template <template <class...> class Map>
+static void BM_Insert_Cpp(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  DispatchPayload(payload, [&](auto key_tag, auto value_tag) {
+    using Key = typename decltype(key_tag)::type;
+    using Value = typename decltype(value_tag)::type;
+    const auto keys = MakeKeys(key_tag, payload);
+    RunBatched(
+        state, [] { return new Map<Key, Value>; },
+        [&](auto map) {
+          for (size_t i = 0; i < keys.size(); ++i) {
+            map->emplace(keys[i], MakeValue(value_tag, payload, i));
+          }
+        },
+        [](auto map) { delete map; });
+  });
+}
+P(BENCHMARK_TEMPLATE(BM_Insert_Cpp, std::map));
+P(BENCHMARK_TEMPLATE(BM_Insert_Cpp, std::unordered_map));
+
+static GTree *NewGTree(const Payload &payload)
+{
+  return g_tree_new_full(payload.GDataCmp(), nullptr, payload.KeyFree(),
+                         payload.ValueSize() != 0 ? std::free : nullptr);
+}
+
+static void BM_Insert_GTree(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state, [&] { return NewGTree(payload); },
+      [&](auto tree) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          g_tree_insert(tree, payload.MakeKey(i), payload.MakeValue(i));
+        }
+      },
+      g_tree_destroy);
+}
+P(BENCHMARK(BM_Insert_GTree));
+
+static GHashTable *NewGHashTable(const Payload &payload)
+{
+  return g_hash_table_new_full(payload.GHash(), payload.Equil(),
+                               payload.KeyFree(),
+                               payload.ValueSize() != 0 ? std::free : nullptr);
+}
+
+static void BM_Insert_GHashTable(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state, [&] { return NewGHashTable(payload); },
+      [&](auto table) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          g_hash_table_insert(table, payload.MakeKey(i), payload.MakeValue(i));
+        }
+      },
+      g_hash_table_destroy);
+}
+P(BENCHMARK(BM_Insert_GHashTable));
+
+static struct cdc_data_info MakeMapInfo(const Payload &payload)
+{
+  struct cdc_data_info info = {};
+  info.dfree = payload.PairFree();
+  info.cmp = payload.Less();
+  info.eq = payload.Equil();
+  info.hash = payload.Hash();
+  return info;
+}
+
+static void BM_Insert_CdcMap(benchmark::State &state,
+                             const struct cdc_map_table *table)
+{
+  const Payload payload = MakePayload(state);
+  struct cdc_data_info info = MakeMapInfo(payload);
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_map *map = nullptr;
+        cdc_map_ctor(table, &map, &info);
+        return map;
+      },
+      [&](auto map) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          cdc_map_insert(map, payload.MakeKey(i), payload.MakeValue(i),
+                         nullptr, nullptr);
+        }
+      },
+      cdc_map_dtor);
+}
+P(BENCHMARK_CAPTURE(BM_Insert_CdcMap, hash_table, cdc_map_htable));
+P(BENCHMARK_CAPTURE(BM_Insert_CdcMap, avl_tree, cdc_map_avl));
+P(BENCHMARK_CAPTURE(BM_Insert_CdcMap, treep, cdc_map_treap));
+P(BENCHMARK_CAPTURE(BM_Insert_CdcMap, splay_tree, cdc_map_splay));
+
+// Collections-C maps are left out: they have no destroy callbacks and do not
+// hand back stored keys on removal, so they cannot own keys.
+
+// Remove benchmarks:
+template <template <class...> class Map>
+static void BM_Remove_Cpp(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  DispatchPayload(payload, [&](auto key_tag, auto value_tag) {
+    using Key = typename decltype(key_tag)::type;
+    using Value = typename decltype(value_tag)::type;
+    const auto keys = MakeKeys(key_tag, payload);
+    RunBatched(
+        state,
+        [&] {
+          auto map = new Map<Key, Value>;
+          for (size_t i = 0; i < keys.size(); ++i) {
+            map->emplace(keys[i], MakeValue(value_tag, payload, i));
+          }
+          return map;
+        },
+        [&](auto map) {
+          for (size_t i = keys.size(); i-- > 0;) {
+            map->erase(keys[i]);
+          }
+        },
+        [](auto map) { delete map; });
+  });
+}
+P(BENCHMARK_TEMPLATE(BM_Remove_Cpp, std::map));
+P(BENCHMARK_TEMPLATE(BM_Remove_Cpp, std::unordered_map));
+
+static void BM_Remove_GTree(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state,
+      [&] {
+        GTree *tree = NewGTree(payload);
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          g_tree_insert(tree, payload.MakeKey(i), payload.MakeValue(i));
+        }
+        return tree;
+      },
+      [&](auto tree) {
+        for (size_t i = payload.Size(); i-- > 0;) {
+          g_tree_remove(tree, payload.Key(i));
+        }
+      },
+      g_tree_destroy);
+}
+P(BENCHMARK(BM_Remove_GTree));
+
+static void BM_Remove_GHashTable(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state,
+      [&] {
+        GHashTable *table = NewGHashTable(payload);
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          g_hash_table_insert(table, payload.MakeKey(i), payload.MakeValue(i));
+        }
+        return table;
+      },
+      [&](auto table) {
+        for (size_t i = payload.Size(); i-- > 0;) {
+          g_hash_table_remove(table, payload.Key(i));
+        }
+      },
+      g_hash_table_destroy);
+}
+P(BENCHMARK(BM_Remove_GHashTable));
+
+static void BM_Remove_CdcMap(benchmark::State &state,
+                             const struct cdc_map_table *table)
+{
+  const Payload payload = MakePayload(state);
+  struct cdc_data_info info = MakeMapInfo(payload);
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_map *map = nullptr;
+        cdc_map_ctor(table, &map, &info);
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          cdc_map_insert(map, payload.MakeKey(i), payload.MakeValue(i),
+                         nullptr, nullptr);
+        }
+        return map;
+      },
+      [&](auto map) {
+        for (size_t i = payload.Size(); i-- > 0;) {
+          cdc_map_erase(map, payload.Key(i));
+        }
+      },
+      cdc_map_dtor);
+}
+P(BENCHMARK_CAPTURE(BM_Remove_CdcMap, hash_table, cdc_map_htable));
+P(BENCHMARK_CAPTURE(BM_Remove_CdcMap, avl_tree, cdc_map_avl));
+P(BENCHMARK_CAPTURE(BM_Remove_CdcMap, treep, cdc_map_treap));
+P(BENCHMARK_CAPTURE(BM_Remove_CdcMap, splay_tree, cdc_map_splay));
+
+// Search benchmarks:
+template <template <class...> class Map>
+static void BM_Search_Cpp(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  DispatchPayload(payload, [&](auto key_tag, auto value_tag) {
+    using Key = typename decltype(key_tag)::type;
+    using Value = typename decltype(value_tag)::type;
+    const auto keys = MakeKeys(key_tag, payload);
+    RunBatched(
+        state,
+        [&] {
+          auto map = new Map<Key, Value>;
+          for (size_t i = 0; i < keys.size(); ++i) {
+            map->emplace(keys[i], MakeValue(value_tag, payload, i));
+          }
+          return map;
+        },
+        [&](auto map) {
+          for (size_t i = keys.size(); i-- > 0;) {
+            benchmark::DoNotOptimize(map->find(keys[i]));
+          }
+        },
+        [](auto map) { delete map; });
+  });
+}
+P(BENCHMARK_TEMPLATE(BM_Search_Cpp, std::map));
+P(BENCHMARK_TEMPLATE(BM_Search_Cpp, std::unordered_map));
+
+static void BM_Search_GTree(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state,
+      [&] {
+        GTree *tree = NewGTree(payload);
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          g_tree_insert(tree, payload.MakeKey(i), payload.MakeValue(i));
+        }
+        return tree;
+      },
+      [&](auto tree) {
+        for (size_t i = payload.Size(); i-- > 0;) {
+          benchmark::DoNotOptimize(g_tree_lookup(tree, payload.Key(i)));
+        }
+      },
+      g_tree_destroy);
+}
+P(BENCHMARK(BM_Search_GTree));
+
+static void BM_Search_GHashTable(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state,
+      [&] {
+        GHashTable *table = NewGHashTable(payload);
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          g_hash_table_insert(table, payload.MakeKey(i), payload.MakeValue(i));
+        }
+        return table;
+      },
+      [&](auto table) {
+        for (size_t i = payload.Size(); i-- > 0;) {
+          benchmark::DoNotOptimize(g_hash_table_lookup(table, payload.Key(i)));
+        }
+      },
+      g_hash_table_destroy);
+}
+P(BENCHMARK(BM_Search_GHashTable));
+
+static void BM_Search_CdcMap(benchmark::State &state,
+                             const struct cdc_map_table *table)
+{
+  const Payload payload = MakePayload(state);
+  struct cdc_data_info info = MakeMapInfo(payload);
+  void *value = nullptr;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_map *map = nullptr;
+        cdc_map_ctor(table, &map, &info);
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          cdc_map_insert(map, payload.MakeKey(i), payload.MakeValue(i),
+                         nullptr, nullptr);
+        }
+        return map;
+      },
+      [&](auto map) {
+        for (size_t i = payload.Size(); i-- > 0;) {
+          benchmark::DoNotOptimize(cdc_map_get(map, payload.Key(i), &value));
+        }
+      },
+      cdc_map_dtor);
+}
+P(BENCHMARK_CAPTURE(BM_Search_CdcMap, hash_table, cdc_map_htable));
+P(BENCHMARK_CAPTURE(BM_Search_CdcMap, avl_tree, cdc_map_avl));
+P(BENCHMARK_CAPTURE(BM_Search_CdcMap, treep, cdc_map_treap));
+P(BENCHMARK_CAPTURE(BM_Search_CdcMap, splay_tree, cdc_map_splay));
+
+// Push back benchmarks:
+// Standard sequences hold std::string or std::unique_ptr elements.
+template <template <class...> class Sequence>
+static void BM_PushBack_Cpp(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  DispatchPayload(payload, [&](auto key_tag, auto value_tag) {
+    using Key = typename decltype(key_tag)::type;
+    using Value = typename decltype(value_tag)::type;
+    if constexpr (std::is_same<Key, std::string>::value) {
+      const auto keys = MakeKeys(key_tag, payload);
+      RunBatched(
+          state, [] { return new Sequence<Key>; },
+          [&](auto sequence) {
+            for (const auto &key : keys) {
+              sequence->push_back(key);
+            }
+          },
+          [](auto sequence) { delete sequence; });
+    } else {
+      RunBatched(
+          state, [] { return new Sequence<Value>; },
+          [&](auto sequence) {
+            for (size_t i = 0; i < payload.Size(); ++i) {
+              sequence->push_back(MakeValue(value_tag, payload, i));
+            }
+          },
+          [](auto sequence) { delete sequence; });
+    }
+  });
+}
+P(BENCHMARK_TEMPLATE(BM_PushBack_Cpp, std::list));
+P(BENCHMARK_TEMPLATE(BM_PushBack_Cpp, std::deque));
+
+static void BM_PushBack_CcList(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state,
+      [] {
+        List *list = nullptr;
+        list_new(&list);
+        return list;
+      },
+      [&](auto list) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          list_add_last(list, payload.MakeElement(i));
+        }
+      },
+      [](auto list) { list_destroy_cb(list, std::free); });
+}
+P(BENCHMARK(BM_PushBack_CcList));
+
+static void BM_PushBack_CcDeque(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state,
+      [] {
+        Deque *deque = nullptr;
+        deque_new(&deque);
+        return deque;
+      },
+      [&](auto deque) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          deque_add_last(deque, payload.MakeElement(i));
+        }
+      },
+      [](auto deque) { deque_destroy_cb(deque, std::free); });
+}
+P(BENCHMARK(BM_PushBack_CcDeque));
+
+static void BM_PushBack_GList(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state, []() -> GList * { return nullptr; },
+      [&](auto &list) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          list = g_list_append(list, payload.MakeElement(i));
+        }
+      },
+      [](auto list) { g_list_free_full(list, std::free); });
+}
+P(BENCHMARK(BM_PushBack_GList));
+
+static void BM_PushBack_GQueue(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  RunBatched(
+      state, g_queue_new,
+      [&](auto queue) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          g_queue_push_tail(queue, payload.MakeElement(i));
+        }
+      },
+      [](auto queue) { g_queue_free_full(queue, std::free); });
+}
+P(BENCHMARK(BM_PushBack_GQueue));
+
+static void BM_PushBack_CdcList(benchmark::State &state)
+{
+  const Payload payload = MakePayload(state);
+  struct cdc_data_info info = {};
+  info.dfree = std::free;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_list *list = nullptr;
+        cdc_list_ctor(&list, &info);
+        return list;
+      },
+      [&](auto list) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          cdc_list_push_back(list, payload.MakeElement(i));
+        }
+      },
+      cdc_list_dtor);
+}
+P(BENCHMARK(BM_PushBack_CdcList));
+
+static void BM_PushBack_CdcDeque(benchmark::State &state,
+                                 const struct cdc_sequence_table *table)
+{
+  const Payload payload = MakePayload(state);
+  struct cdc_data_info info = {};
+  info.dfree = std::free;
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_deque *deque = nullptr;
+        cdc_deque_ctor(table, &deque, &info);
+        return deque;
+      },
+      [&](auto deque) {
+        for (size_t i = 0; i < payload.Size(); ++i) {
+          cdc_deque_push_back(deque, payload.MakeElement(i));
+        }
+      },
+      cdc_deque_dtor);
+}
+P(BENCHMARK_CAPTURE(BM_PushBack_CdcDeque, circular_array, cdc_seq_carray));
+P(BENCHMARK_CAPTURE(BM_PushBack_CdcDeque, list, cdc_seq_list));
+
+BENCH_MAIN();
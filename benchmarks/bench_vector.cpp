@@ -0,0 +1,658 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+extern "C" {
+#include <cdcontainers/cdc.h>
+#include <collectc/array.h>
+#include <gmodule.h>
+}
+
+#include <benchmark/benchmark.h>
+
+#include "benchmarks/utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <vector>
+
+// Dynamic arrays hold int keys: std::vector and GArray by value, the others
+// as pointers made with CDC_FROM_INT, as the other containers do.
+template <class Keys>
+static std::vector<int> *NewCppVector(const Keys &keys)
+{
+  return new std::vector<int>(std::cbegin(keys), std::cend(keys));
+}
+
+template <class Keys>
+static struct cdc_vector *NewCdcVector(const Keys &keys)
+{
+  struct cdc_vector *vector = nullptr;
+  cdc_vector_ctor(&vector, nullptr);
+  for (auto key : keys) {
+    cdc_vector_push_back(vector, CDC_FROM_INT(key));
+  }
+  return vector;
+}
+
+template <class Keys>
+static GArray *NewGArray(const Keys &keys)
+{
+  GArray *array = g_array_new(FALSE, FALSE, sizeof(int));
+  for (auto key : keys) {
+    g_array_append_val(array, key);
+  }
+  return array;
+}
+
+template <class Keys>
+static GPtrArray *NewGPtrArray(const Keys &keys)
+{
+  GPtrArray *array = g_ptr_array_new();
+  for (auto key : keys) {
+    g_ptr_array_add(array, CDC_FROM_INT(key));
+  }
+  return array;
+}
+
+template <class Keys>
+static Array *NewCcArray(const Keys &keys)
+{
+  Array *array = nullptr;
+  array_new(&array);
+  for (auto key : keys) {
+    array_add(array, CDC_FROM_INT(key));
+  }
+  return array;
+}
+
+static void FreeGArray(GArray *array) { g_array_free(array, TRUE); }
+
+static void FreeGPtrArray(GPtrArray *array) { g_ptr_array_free(array, TRUE); }
+
+// Push back benchmarks:
+static void BM_PushBack_CppVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return new std::vector<int>(); },
+      [&](auto vector) {
+        for (auto key : keys) {
+          vector->push_back(key);
+        }
+      },
+      [](auto vector) { delete vector; });
+}
+S(BENCHMARK(BM_PushBack_CppVector));
+
+static void BM_PushBack_CdcVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        struct cdc_vector *vector = nullptr;
+        cdc_vector_ctor(&vector, nullptr);
+        return vector;
+      },
+      [&](auto vector) {
+        for (auto key : keys) {
+          cdc_vector_push_back(vector, CDC_FROM_INT(key));
+        }
+      },
+      cdc_vector_dtor);
+}
+S(BENCHMARK(BM_PushBack_CdcVector));
+
+static void BM_PushBack_GArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [] { return g_array_new(FALSE, FALSE, sizeof(int)); },
+      [&](auto array) {
+        for (auto key : keys) {
+          g_array_append_val(array, key);
+        }
+      },
+      FreeGArray);
+}
+S(BENCHMARK(BM_PushBack_GArray));
+
+static void BM_PushBack_GPtrArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, g_ptr_array_new,
+      [&](auto array) {
+        for (auto key : keys) {
+          g_ptr_array_add(array, CDC_FROM_INT(key));
+        }
+      },
+      FreeGPtrArray);
+}
+S(BENCHMARK(BM_PushBack_GPtrArray));
+
+static void BM_PushBack_CcArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [] {
+        Array *array = nullptr;
+        array_new(&array);
+        return array;
+      },
+      [&](auto array) {
+        for (auto key : keys) {
+          array_add(array, CDC_FROM_INT(key));
+        }
+      },
+      array_destroy);
+}
+S(BENCHMARK(BM_PushBack_CcArray));
+
+// Push back reserved benchmarks:
+// The same pushes into arrays that reserved room for N elements before the
+// clock starts, so they never grow: the gap to PushBack is the cost of
+// growth.
+static void BM_PushBackReserved_CppVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        auto vector = new std::vector<int>();
+        vector->reserve(keys.Size());
+        return vector;
+      },
+      [&](auto vector) {
+        for (auto key : keys) {
+          vector->push_back(key);
+        }
+      },
+      [](auto vector) { delete vector; });
+}
+S(BENCHMARK(BM_PushBackReserved_CppVector));
+
+static void BM_PushBackReserved_CdcVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        struct cdc_vector *vector = nullptr;
+        cdc_vector_ctor(&vector, nullptr);
+        cdc_vector_reserve(vector, keys.Size());
+        return vector;
+      },
+      [&](auto vector) {
+        for (auto key : keys) {
+          cdc_vector_push_back(vector, CDC_FROM_INT(key));
+        }
+      },
+      cdc_vector_dtor);
+}
+S(BENCHMARK(BM_PushBackReserved_CdcVector));
+
+static void BM_PushBackReserved_GArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        return g_array_sized_new(FALSE, FALSE, sizeof(int),
+                                 static_cast<guint>(keys.Size()));
+      },
+      [&](auto array) {
+        for (auto key : keys) {
+          g_array_append_val(array, key);
+        }
+      },
+      FreeGArray);
+}
+S(BENCHMARK(BM_PushBackReserved_GArray));
+
+static void BM_PushBackReserved_GPtrArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] { return g_ptr_array_sized_new(static_cast<guint>(keys.Size())); },
+      [&](auto array) {
+        for (auto key : keys) {
+          g_ptr_array_add(array, CDC_FROM_INT(key));
+        }
+      },
+      FreeGPtrArray);
+}
+S(BENCHMARK(BM_PushBackReserved_GPtrArray));
+
+static void BM_PushBackReserved_CcArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state,
+      [&] {
+        ArrayConf conf;
+        array_conf_init(&conf);
+        conf.capacity = keys.Size();
+        Array *array = nullptr;
+        array_new_conf(&conf, &array);
+        return array;
+      },
+      [&](auto array) {
+        for (auto key : keys) {
+          array_add(array, CDC_FROM_INT(key));
+        }
+      },
+      array_destroy);
+}
+S(BENCHMARK(BM_PushBackReserved_CcArray));
+
+// Insert rand pos benchmarks:
+static void BM_InsertRandPos_CppVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 5);
+  RunBatched(
+      state, [] { return new std::vector<int>{1, 2, 3, 4, 5}; },
+      [&](auto vector) {
+        for (size_t j = 0; j < keys.Size(); ++j) {
+          vector->insert(std::begin(*vector) + positions[j], keys[j]);
+        }
+      },
+      [](auto vector) { delete vector; });
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_CppVector));
+
+static void BM_InsertRandPos_CdcVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 5);
+  RunBatched(
+      state, [] { return NewCdcVector(std::vector<int>{1, 2, 3, 4, 5}); },
+      [&](auto vector) {
+        for (size_t j = 0; j < keys.Size(); ++j) {
+          cdc_vector_insert(vector, positions[j], CDC_FROM_INT(keys[j]));
+        }
+      },
+      cdc_vector_dtor);
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_CdcVector));
+
+static void BM_InsertRandPos_GArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 5);
+  RunBatched(
+      state, [] { return NewGArray(std::vector<int>{1, 2, 3, 4, 5}); },
+      [&](auto array) {
+        for (size_t j = 0; j < keys.Size(); ++j) {
+          const int key = keys[j];
+          g_array_insert_val(array, static_cast<guint>(positions[j]), key);
+        }
+      },
+      FreeGArray);
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_GArray));
+
+static void BM_InsertRandPos_GPtrArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 5);
+  RunBatched(
+      state, [] { return NewGPtrArray(std::vector<int>{1, 2, 3, 4, 5}); },
+      [&](auto array) {
+        for (size_t j = 0; j < keys.Size(); ++j) {
+          g_ptr_array_insert(array, static_cast<gint>(positions[j]),
+                             CDC_FROM_INT(keys[j]));
+        }
+      },
+      FreeGPtrArray);
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_GPtrArray));
+
+static void BM_InsertRandPos_CcArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 5);
+  RunBatched(
+      state, [] { return NewCcArray(std::vector<int>{1, 2, 3, 4, 5}); },
+      [&](auto array) {
+        for (size_t j = 0; j < keys.Size(); ++j) {
+          array_add_at(array, CDC_FROM_INT(keys[j]), positions[j]);
+        }
+      },
+      array_destroy);
+}
+S_SMALL(BENCHMARK(BM_InsertRandPos_CcArray));
+
+// Erase rand pos benchmarks:
+// Arrays of N elements are emptied by erasing at random positions. The
+// positions of inserts into an empty array, taken in reverse, are valid
+// positions of erases down to an empty array.
+static void BM_EraseRandPos_CppVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state, [&] { return NewCppVector(keys); },
+      [&](auto vector) {
+        std::for_each(
+            std::crbegin(positions), std::crend(positions),
+            [=](auto pos) { vector->erase(std::begin(*vector) + pos); });
+      },
+      [](auto vector) { delete vector; });
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_CppVector));
+
+static void BM_EraseRandPos_CdcVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state, [&] { return NewCdcVector(keys); },
+      [&](auto vector) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) { cdc_vector_erase(vector, pos); });
+      },
+      cdc_vector_dtor);
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_CdcVector));
+
+static void BM_EraseRandPos_GArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state, [&] { return NewGArray(keys); },
+      [&](auto array) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) {
+                        g_array_remove_index(array, static_cast<guint>(pos));
+                      });
+      },
+      FreeGArray);
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_GArray));
+
+static void BM_EraseRandPos_GPtrArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state, [&] { return NewGPtrArray(keys); },
+      [&](auto array) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) {
+                        g_ptr_array_remove_index(array,
+                                                 static_cast<guint>(pos));
+                      });
+      },
+      FreeGPtrArray);
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_GPtrArray));
+
+static void BM_EraseRandPos_CcArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto positions = RandomPositions(keys.Size(), 0);
+  RunBatched(
+      state, [&] { return NewCcArray(keys); },
+      [&](auto array) {
+        std::for_each(std::crbegin(positions), std::crend(positions),
+                      [=](auto pos) { array_remove_at(array, pos, nullptr); });
+      },
+      array_destroy);
+}
+S_SMALL(BENCHMARK(BM_EraseRandPos_CcArray));
+
+// Random get benchmarks:
+// Arrays of N elements read N elements at random positions.
+static void BM_RandomGet_CppVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunReused(
+      state, [&] { return NewCppVector(keys); },
+      [&](auto vector) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize((*vector)[i]);
+        }
+      },
+      [](auto vector) { delete vector; });
+}
+S(BENCHMARK(BM_RandomGet_CppVector));
+
+static void BM_RandomGet_CdcVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunReused(
+      state, [&] { return NewCdcVector(keys); },
+      [&](auto vector) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize(cdc_vector_get(vector, i));
+        }
+      },
+      cdc_vector_dtor);
+}
+S(BENCHMARK(BM_RandomGet_CdcVector));
+
+static void BM_RandomGet_GArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunReused(
+      state, [&] { return NewGArray(keys); },
+      [&](auto array) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize(g_array_index(array, int, i));
+        }
+      },
+      FreeGArray);
+}
+S(BENCHMARK(BM_RandomGet_GArray));
+
+static void BM_RandomGet_GPtrArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  RunReused(
+      state, [&] { return NewGPtrArray(keys); },
+      [&](auto array) {
+        for (auto i : indices) {
+          benchmark::DoNotOptimize(g_ptr_array_index(array, i));
+        }
+      },
+      FreeGPtrArray);
+}
+S(BENCHMARK(BM_RandomGet_GPtrArray));
+
+static void BM_RandomGet_CcArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  const auto indices = RandomIndices(keys.Size(), keys.Size());
+  void *value = nullptr;
+  RunReused(
+      state, [&] { return NewCcArray(keys); },
+      [&](auto array) {
+        for (auto i : indices) {
+          array_get_at(array, i, &value);
+          benchmark::DoNotOptimize(value);
+        }
+      },
+      array_destroy);
+}
+S(BENCHMARK(BM_RandomGet_CcArray));
+
+// Iteration benchmarks:
+// Arrays of N elements add up their keys in order, with the walk of the
+// library: indices for cdc_vector and glib arrays, an iterator for
+// Collections-C.
+static void BM_Iteration_CppVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state, [&] { return NewCppVector(keys); },
+      [](auto vector) {
+        int64_t sum = 0;
+        for (auto key : *vector) {
+          sum += key;
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      [](auto vector) { delete vector; });
+}
+S(BENCHMARK(BM_Iteration_CppVector));
+
+static void BM_Iteration_CdcVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state, [&] { return NewCdcVector(keys); },
+      [](auto vector) {
+        int64_t sum = 0;
+        const size_t size = cdc_vector_size(vector);
+        for (size_t i = 0; i < size; ++i) {
+          sum += CDC_TO_INT(cdc_vector_get(vector, i));
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      cdc_vector_dtor);
+}
+S(BENCHMARK(BM_Iteration_CdcVector));
+
+static void BM_Iteration_GArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state, [&] { return NewGArray(keys); },
+      [](auto array) {
+        int64_t sum = 0;
+        for (guint i = 0; i < array->len; ++i) {
+          sum += g_array_index(array, int, i);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      FreeGArray);
+}
+S(BENCHMARK(BM_Iteration_GArray));
+
+static void BM_Iteration_GPtrArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state, [&] { return NewGPtrArray(keys); },
+      [](auto array) {
+        int64_t sum = 0;
+        for (guint i = 0; i < array->len; ++i) {
+          sum += CDC_TO_INT(g_ptr_array_index(array, i));
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      FreeGPtrArray);
+}
+S(BENCHMARK(BM_Iteration_GPtrArray));
+
+static void BM_Iteration_CcArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunReused(
+      state, [&] { return NewCcArray(keys); },
+      [](auto array) {
+        int64_t sum = 0;
+        ArrayIter iter = {};
+        array_iter_init(&iter, array);
+        void *value = nullptr;
+        while (array_iter_next(&iter, &value) != CC_ITER_END) {
+          sum += CDC_TO_INT(value);
+        }
+        benchmark::DoNotOptimize(sum);
+      },
+      array_destroy);
+}
+S(BENCHMARK(BM_Iteration_CcArray));
+
+// Sort benchmarks:
+// Arrays of N uniform keys are built before the clock starts and sorted once.
+// cdc_vector has no sort, so its buffer is sorted with qsort() and the
+// comparator of Collections-C, as a C program would do; glib and Collections-C
+// sort with the same kind of comparator.
+static int GArrayCmp(const void *lhs, const void *rhs)
+{
+  const int l = *static_cast<const int *>(lhs);
+  const int r = *static_cast<const int *>(rhs);
+  return (l > r) - (l < r);
+}
+
+static void BM_Sort_CppVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCppVector(keys); },
+      [](auto vector) { std::sort(std::begin(*vector), std::end(*vector)); },
+      [](auto vector) { delete vector; });
+}
+S(BENCHMARK(BM_Sort_CppVector));
+
+static void BM_Sort_CdcVector(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCdcVector(keys); },
+      [](auto vector) {
+        std::qsort(cdc_vector_data(vector), cdc_vector_size(vector),
+                   sizeof(void *), CcElementCmp);
+      },
+      cdc_vector_dtor);
+}
+S(BENCHMARK(BM_Sort_CdcVector));
+
+static void BM_Sort_GArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewGArray(keys); },
+      [](auto array) { g_array_sort(array, GArrayCmp); }, FreeGArray);
+}
+S(BENCHMARK(BM_Sort_GArray));
+
+static void BM_Sort_GPtrArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewGPtrArray(keys); },
+      [](auto array) { g_ptr_array_sort(array, CcElementCmp); },
+      FreeGPtrArray);
+}
+S(BENCHMARK(BM_Sort_GPtrArray));
+
+static void BM_Sort_CcArray(benchmark::State &state)
+{
+  const KeyStream keys(static_cast<size_t>(state.range(0)));
+  RunBatched(
+      state, [&] { return NewCcArray(keys); },
+      [](auto array) { array_sort(array, CcElementCmp); }, array_destroy);
+}
+S(BENCHMARK(BM_Sort_CcArray));
+
+BENCH_MAIN();
@@ -0,0 +1,419 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+
+// A B+-tree as a reference for the binary trees: nodes are four cache lines,
+// aligned on a cache line, and keys are kept apart from values and children,
+// so that finding the way through a node reads only the first two lines.
+// Entries are in the leaves, which are linked in key order for iteration.
+// Nodes other than the root hold at least half as many keys as they can.
+template <class Less>
+class BPlusTree
+{
+ public:
+  BPlusTree() : _root(NewLeaf()) {}
+  ~BPlusTree() { Free(_root); }
+
+  BPlusTree(const BPlusTree &) = delete;
+  BPlusTree &operator=(const BPlusTree &) = delete;
+
+  size_t Size() const { return _size; }
+
+  bool Get(void *key, void **value) const
+  {
+    const Leaf *leaf = FindLeaf(key);
+    const int i = LowerBound(leaf->keys, leaf->count, key);
+    if (i == leaf->count || _less(key, leaf->keys[i])) {
+      return false;
+    }
+    *value = leaf->values[i];
+    return true;
+  }
+
+  // Returns false if the key is already present.
+  bool Insert(void *key, void *value)
+  {
+    Split split;
+    const Result result = Insert(_root, key, value, &split);
+    if (result == Result::kExists) {
+      return false;
+    }
+    if (result == Result::kSplit) {
+      Inner *root = NewInner();
+      root->count = 1;
+      root->keys[0] = split.key;
+      root->children[0] = _root;
+      root->children[1] = split.right;
+      _root = root;
+    }
+    ++_size;
+    return true;
+  }
+
+  bool Erase(void *key)
+  {
+    if (!Erase(_root, key)) {
+      return false;
+    }
+    if (!_root->leaf && _root->count == 0) {
+      Node *child = static_cast<Inner *>(_root)->children[0];
+      std::free(_root);
+      _root = child;
+    }
+    --_size;
+    return true;
+  }
+
+  // Calls fn(key, value) for every entry, in key order.
+  template <typename Fn>
+  void ForEach(Fn &&fn) const
+  {
+    const Node *node = _root;
+    while (!node->leaf) {
+      node = static_cast<const Inner *>(node)->children[0];
+    }
+    for (auto leaf = static_cast<const Leaf *>(node); leaf != nullptr;
+         leaf = leaf->next) {
+      for (int i = 0; i < leaf->count; ++i) {
+        fn(leaf->keys[i], leaf->values[i]);
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kNodeSize = 256;
+  static constexpr size_t kCacheLine = 64;
+  static constexpr int kOrder = 15;
+  static constexpr int kMinKeys = kOrder / 2;
+
+  struct Node {
+    int count;
+    bool leaf;
+  };
+
+  struct Leaf : Node {
+    void *keys[kOrder];
+    void *values[kOrder];
+    Leaf *next;
+  };
+
+  struct Inner : Node {
+    void *keys[kOrder];
+    Node *children[kOrder + 1];
+  };
+
+  static_assert(sizeof(Leaf) == kNodeSize, "a leaf must fill its lines");
+  static_assert(sizeof(Inner) == kNodeSize, "a node must fill its lines");
+
+  enum class Result {
+    kExists,
+    kInserted,
+    kSplit,
+  };
+
+  // The first key of the new right node and the node itself.
+  struct Split {
+    void *key;
+    Node *right;
+  };
+
+  static Leaf *NewLeaf()
+  {
+    auto leaf = static_cast<Leaf *>(std::aligned_alloc(kCacheLine, kNodeSize));
+    leaf->count = 0;
+    leaf->leaf = true;
+    leaf->next = nullptr;
+    return leaf;
+  }
+
+  static Inner *NewInner()
+  {
+    auto inner =
+        static_cast<Inner *>(std::aligned_alloc(kCacheLine, kNodeSize));
+    inner->count = 0;
+    inner->leaf = false;
+    return inner;
+  }
+
+  static void Free(Node *node)
+  {
+    if (!node->leaf) {
+      auto inner = static_cast<Inner *>(node);
+      for (int i = 0; i <= inner->count; ++i) {
+        Free(inner->children[i]);
+      }
+    }
+    std::free(node);
+  }
+
+  template <typename T>
+  static void InsertAt(T *a, int count, int i, T v)
+  {
+    std::copy_backward(a + i, a + count, a + count + 1);
+    a[i] = v;
+  }
+
+  template <typename T>
+  static void EraseAt(T *a, int count, int i)
+  {
+    std::copy(a + i + 1, a + count, a + i);
+  }
+
+  // The first key not less than `key`.
+  int LowerBound(void *const *keys, int count, void *key) const
+  {
+    int i = 0;
+    while (i < count && _less(keys[i], key)) {
+      ++i;
+    }
+    return i;
+  }
+
+  // The first key greater than `key`, which is also the child to descend to.
+  int UpperBound(void *const *keys, int count, void *key) const
+  {
+    int i = 0;
+    while (i < count && !_less(key, keys[i])) {
+      ++i;
+    }
+    return i;
+  }
+
+  const Leaf *FindLeaf(void *key) const
+  {
+    const Node *node = _root;
+    while (!node->leaf) {
+      auto inner = static_cast<const Inner *>(node);
+      node = inner->children[UpperBound(inner->keys, inner->count, key)];
+    }
+    return static_cast<const Leaf *>(node);
+  }
+
+  Result Insert(Node *node, void *key, void *value, Split *split)
+  {
+    if (node->leaf) {
+      auto leaf = static_cast<Leaf *>(node);
+      const int i = LowerBound(leaf->keys, leaf->count, key);
+      if (i < leaf->count && !_less(key, leaf->keys[i])) {
+        return Result::kExists;
+      }
+      if (leaf->count < kOrder) {
+        InsertAt(leaf->keys, leaf->count, i, key);
+        InsertAt(leaf->values, leaf->count, i, value);
+        ++leaf->count;
+        return Result::kInserted;
+      }
+      SplitLeaf(leaf, i, key, value, split);
+      return Result::kSplit;
+    }
+
+    auto inner = static_cast<Inner *>(node);
+    const int i = UpperBound(inner->keys, inner->count, key);
+    Split child;
+    const Result result = Insert(inner->children[i], key, value, &child);
+    if (result != Result::kSplit) {
+      return result;
+    }
+    if (inner->count < kOrder) {
+      InsertAt(inner->keys, inner->count, i, child.key);
+      InsertAt(inner->children, inner->count + 1, i + 1, child.right);
+      ++inner->count;
+      return Result::kInserted;
+    }
+    SplitInner(inner, i, child, split);
+    return Result::kSplit;
+  }
+
+  // Splits a full leaf in halves while inserting the entry at i.
+  static void SplitLeaf(Leaf *leaf, int i, void *key, void *value,
+                        Split *split)
+  {
+    void *keys[kOrder + 1];
+    void *values[kOrder + 1];
+    std::copy(leaf->keys, leaf->keys + kOrder, keys);
+    std::copy(leaf->values, leaf->values + kOrder, values);
+    InsertAt(keys, kOrder, i, key);
+    InsertAt(values, kOrder, i, value);
+
+    Leaf *right = NewLeaf();
+    leaf->count = (kOrder + 1) / 2;
+    right->count = kOrder + 1 - leaf->count;
+    std::copy(keys, keys + leaf->count, leaf->keys);
+    std::copy(values, values + leaf->count, leaf->values);
+    std::copy(keys + leaf->count, keys + kOrder + 1, right->keys);
+    std::copy(values + leaf->count, values + kOrder + 1, right->values);
+    right->next = leaf->next;
+    leaf->next = right;
+    *split = {right->keys[0], right};
+  }
+
+  // Splits a full inner node while inserting the split of its child i: the
+  // middle key moves up to the parent.
+  static void SplitInner(Inner *inner, int i, const Split &child, Split *split)
+  {
+    void *keys[kOrder + 1];
+    Node *children[kOrder + 2];
+    std::copy(inner->keys, inner->keys + kOrder, keys);
+    std::copy(inner->children, inner->children + kOrder + 1, children);
+    InsertAt(keys, kOrder, i, child.key);
+    InsertAt(children, kOrder + 1, i + 1, child.right);
+
+    Inner *right = NewInner();
+    inner->count = (kOrder + 1) / 2;
+    right->count = kOrder - inner->count;
+    std::copy(keys, keys + inner->count, inner->keys);
+    std::copy(children, children + inner->count + 1, inner->children);
+    std::copy(keys + inner->count + 1, keys + kOrder + 1, right->keys);
+    std::copy(children + inner->count + 1, children + kOrder + 2,
+              right->children);
+    *split = {keys[inner->count], right};
+  }
+
+  bool Erase(Node *node, void *key)
+  {
+    if (node->leaf) {
+      auto leaf = static_cast<Leaf *>(node);
+      const int i = LowerBound(leaf->keys, leaf->count, key);
+      if (i == leaf->count || _less(key, leaf->keys[i])) {
+        return false;
+      }
+      EraseAt(leaf->keys, leaf->count, i);
+      EraseAt(leaf->values, leaf->count, i);
+      --leaf->count;
+      return true;
+    }
+
+    auto inner = static_cast<Inner *>(node);
+    const int i = UpperBound(inner->keys, inner->count, key);
+    if (!Erase(inner->children[i], key)) {
+      return false;
+    }
+    if (inner->children[i]->count < kMinKeys) {
+      Rebalance(inner, i);
+    }
+    return true;
+  }
+
+  // Refills child i of the parent from a sibling that can spare a key, or
+  // merges it with a sibling. Separators left behind by erased keys still
+  // bound their subtrees, so they are only replaced when keys move.
+  static void Rebalance(Inner *parent, int i)
+  {
+    Node *left = i > 0 ? parent->children[i - 1] : nullptr;
+    Node *right = i < parent->count ? parent->children[i + 1] : nullptr;
+    if (left != nullptr && left->count > kMinKeys) {
+      BorrowFromLeft(parent, i);
+    } else if (right != nullptr && right->count > kMinKeys) {
+      BorrowFromRight(parent, i);
+    } else if (left != nullptr) {
+      Merge(parent, i - 1);
+    } else {
+      Merge(parent, i);
+    }
+  }
+
+  static void BorrowFromLeft(Inner *parent, int i)
+  {
+    Node *node = parent->children[i];
+    if (node->leaf) {
+      auto child = static_cast<Leaf *>(node);
+      auto left = static_cast<Leaf *>(parent->children[i - 1]);
+      --left->count;
+      InsertAt(child->keys, child->count, 0, left->keys[left->count]);
+      InsertAt(child->values, child->count, 0, left->values[left->count]);
+      ++child->count;
+      parent->keys[i - 1] = child->keys[0];
+    } else {
+      auto child = static_cast<Inner *>(node);
+      auto left = static_cast<Inner *>(parent->children[i - 1]);
+      InsertAt(child->keys, child->count, 0, parent->keys[i - 1]);
+      InsertAt(child->children, child->count + 1, 0,
+               left->children[left->count]);
+      ++child->count;
+      --left->count;
+      parent->keys[i - 1] = left->keys[left->count];
+    }
+  }
+
+  static void BorrowFromRight(Inner *parent, int i)
+  {
+    Node *node = parent->children[i];
+    if (node->leaf) {
+      auto child = static_cast<Leaf *>(node);
+      auto right = static_cast<Leaf *>(parent->children[i + 1]);
+      child->keys[child->count] = right->keys[0];
+      child->values[child->count] = right->values[0];
+      ++child->count;
+      EraseAt(right->keys, right->count, 0);
+      EraseAt(right->values, right->count, 0);
+      --right->count;
+      parent->keys[i] = right->keys[0];
+    } else {
+      auto child = static_cast<Inner *>(node);
+      auto right = static_cast<Inner *>(parent->children[i + 1]);
+      child->keys[child->count] = parent->keys[i];
+      child->children[child->count + 1] = right->children[0];
+      ++child->count;
+      parent->keys[i] = right->keys[0];
+      EraseAt(right->keys, right->count, 0);
+      EraseAt(right->children, right->count + 1, 0);
+      --right->count;
+    }
+  }
+
+  // Moves child i + 1 of the parent into child i.
+  static void Merge(Inner *parent, int i)
+  {
+    Node *node = parent->children[i];
+    Node *next = parent->children[i + 1];
+    if (node->leaf) {
+      auto left = static_cast<Leaf *>(node);
+      auto right = static_cast<Leaf *>(next);
+      std::copy(right->keys, right->keys + right->count,
+                left->keys + left->count);
+      std::copy(right->values, right->values + right->count,
+                left->values + left->count);
+      left->count += right->count;
+      left->next = right->next;
+    } else {
+      auto left = static_cast<Inner *>(node);
+      auto right = static_cast<Inner *>(next);
+      left->keys[left->count] = parent->keys[i];
+      std::copy(right->keys, right->keys + right->count,
+                left->keys + left->count + 1);
+      std::copy(right->children, right->children + right->count + 1,
+                left->children + left->count + 1);
+      left->count += right->count + 1;
+    }
+    std::free(next);
+    EraseAt(parent->keys, parent->count, i);
+    EraseAt(parent->children, parent->count + 1, i + 1);
+    --parent->count;
+  }
+
+  Node *_root;
+  size_t _size = 0;
+  Less _less;
+};
@@ -0,0 +1,154 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+extern "C" {
+#include <cdcontainers/cdc.h>
+#include <collectc/deque.h>
+#include <gmodule.h>
+}
+
+#include <deque>
+
+// Every deque competitor behind the same int interface, for workloads that
+// run one operation sequence against all of them:
+//   void PushBack(int value);
+//   void PopFront();
+//   int Front();
+// PopFront() and Front() of an empty deque do nothing and return 0.
+
+class CppDeque
+{
+ public:
+  void PushBack(int value) { _c.push_back(value); }
+  void PopFront()
+  {
+    if (!_c.empty()) {
+      _c.pop_front();
+    }
+  }
+  int Front() { return _c.empty() ? 0 : _c.front(); }
+
+ private:
+  std::deque<int> _c;
+};
+
+class CcDeque
+{
+ public:
+  CcDeque() { deque_new(&_deque); }
+  ~CcDeque() { deque_destroy(_deque); }
+
+  CcDeque(const CcDeque &) = delete;
+  CcDeque &operator=(const CcDeque &) = delete;
+
+  void PushBack(int value) { deque_add_last(_deque, CDC_FROM_INT(value)); }
+  void PopFront()
+  {
+    void *value = nullptr;
+    deque_remove_first(_deque, &value);
+  }
+  int Front()
+  {
+    void *value = nullptr;
+    deque_get_first(_deque, &value);
+    return CDC_TO_INT(value);
+  }
+
+ private:
+  Deque *_deque = nullptr;
+};
+
+class GQueueDeque
+{
+ public:
+  GQueueDeque() : _deque(g_queue_new()) {}
+  ~GQueueDeque() { g_queue_free(_deque); }
+
+  GQueueDeque(const GQueueDeque &) = delete;
+  GQueueDeque &operator=(const GQueueDeque &) = delete;
+
+  void PushBack(int value) { g_queue_push_tail(_deque, CDC_FROM_INT(value)); }
+  void PopFront() { g_queue_pop_head(_deque); }
+  int Front() { return CDC_TO_INT(g_queue_peek_head(_deque)); }
+
+ private:
+  GQueue *_deque;
+};
+
+class CdcDeque
+{
+ public:
+  explicit CdcDeque(const struct cdc_sequence_table *table)
+  {
+    cdc_deque_ctor(table, &_deque, nullptr);
+  }
+  ~CdcDeque() { cdc_deque_dtor(_deque); }
+
+  CdcDeque(const CdcDeque &) = delete;
+  CdcDeque &operator=(const CdcDeque &) = delete;
+
+  void PushBack(int value) { cdc_deque_push_back(_deque, CDC_FROM_INT(value)); }
+  void PopFront()
+  {
+    if (cdc_deque_size(_deque) != 0) {
+      cdc_deque_pop_front(_deque);
+    }
+  }
+  int Front()
+  {
+    return cdc_deque_size(_deque) != 0 ? CDC_TO_INT(cdc_deque_front(_deque))
+                                       : 0;
+  }
+
+ private:
+  struct cdc_deque *_deque = nullptr;
+};
+
+class CdcCircularArrayDeque
+{
+ public:
+  CdcCircularArrayDeque() { cdc_circular_array_ctor(&_deque, nullptr); }
+  ~CdcCircularArrayDeque() { cdc_circular_array_dtor(_deque); }
+
+  CdcCircularArrayDeque(const CdcCircularArrayDeque &) = delete;
+  CdcCircularArrayDeque &operator=(const CdcCircularArrayDeque &) = delete;
+
+  void PushBack(int value)
+  {
+    cdc_circular_array_push_back(_deque, CDC_FROM_INT(value));
+  }
+  void PopFront()
+  {
+    if (cdc_circular_array_size(_deque) != 0) {
+      cdc_circular_array_pop_front(_deque);
+    }
+  }
+  int Front()
+  {
+    return cdc_circular_array_size(_deque) != 0
+               ? CDC_TO_INT(cdc_circular_array_front(_deque))
+               : 0;
+  }
+
+ private:
+  struct cdc_circular_array *_deque = nullptr;
+};
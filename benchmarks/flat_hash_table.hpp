@@ -0,0 +1,248 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// An open-addressing hash table in the style of SwissTable, as a reference for
+// the chained tables: a control byte per slot holds 7 bits of the hash of a
+// full slot or marks it empty or deleted, and lookups compare 16 control bytes
+// at once with SSE2 before they touch any key. Probes go over groups of 16
+// slots in triangular steps and stop at the first group with an empty slot.
+// Keys and values are stored inline in the slot array. The table grows at a
+// load of 7/8.
+template <class Hash, class Equal>
+class FlatHashTable
+{
+ public:
+  struct Slot {
+    void *key;
+    void *value;
+  };
+
+  FlatHashTable() { Allocate(kGroupSize); }
+
+  ~FlatHashTable()
+  {
+    std::free(_ctrl);
+    std::free(_slots);
+  }
+
+  FlatHashTable(const FlatHashTable &) = delete;
+  FlatHashTable &operator=(const FlatHashTable &) = delete;
+
+  size_t Size() const { return _size; }
+  size_t BucketCount() const { return _capacity; }
+
+  bool Get(void *key, void **value) const
+  {
+    const size_t i = Find(key, Mix(_hash(key)));
+    if (i == kNotFound) {
+      return false;
+    }
+    *value = _slots[i].value;
+    return true;
+  }
+
+  // Returns false if the key is already present.
+  bool Insert(void *key, void *value)
+  {
+    size_t hash = Mix(_hash(key));
+    if (Find(key, hash) != kNotFound) {
+      return false;
+    }
+    if (_size + _deleted >= _capacity - _capacity / 8) {
+      // Rehashing in place drops the tombstones when they are the most of
+      // the load, growing makes room otherwise.
+      Rehash(_size >= _capacity / 2 ? 2 * _capacity : _capacity);
+    }
+    const size_t i = FindFree(hash);
+    if (_ctrl[i] == kDeleted) {
+      --_deleted;
+    }
+    _ctrl[i] = H2(hash);
+    _slots[i] = {key, value};
+    ++_size;
+    return true;
+  }
+
+  bool Erase(void *key)
+  {
+    const size_t i = Find(key, Mix(_hash(key)));
+    if (i == kNotFound) {
+      return false;
+    }
+    // No probe has passed a group with an empty slot, so the slot can be
+    // emptied there; elsewhere a tombstone keeps probes going.
+    if (MatchEmpty(i & ~(kGroupSize - 1)) != 0) {
+      _ctrl[i] = kEmpty;
+    } else {
+      _ctrl[i] = kDeleted;
+      ++_deleted;
+    }
+    --_size;
+    return true;
+  }
+
+  // Calls fn(key, value) for every entry, in slot order.
+  template <typename Fn>
+  void ForEach(Fn &&fn) const
+  {
+    for (size_t group = 0; group < _capacity; group += kGroupSize) {
+      for (uint32_t m = MatchFull(group); m != 0; m &= m - 1) {
+        const Slot &slot = _slots[group + Ctz(m)];
+        fn(slot.key, slot.value);
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kGroupSize = 16;
+  static constexpr size_t kNotFound = ~static_cast<size_t>(0);
+  static constexpr int8_t kEmpty = -128;
+  static constexpr int8_t kDeleted = -2;
+
+  // Hashes of ints are often the ints themselves, so the bits are mixed (the
+  // halves of a 128-bit product folded together) before the low 7 of them go
+  // to the control byte and the others pick the group.
+  static size_t Mix(size_t hash)
+  {
+    const auto m = static_cast<unsigned __int128>(hash) *
+                   UINT64_C(0x9E3779B97F4A7C15);
+    return static_cast<size_t>(static_cast<uint64_t>(m) ^
+                               static_cast<uint64_t>(m >> 64));
+  }
+  static int8_t H2(size_t hash) { return static_cast<int8_t>(hash & 0x7F); }
+  static size_t H1(size_t hash) { return hash >> 7; }
+
+  static uint32_t Ctz(uint32_t m)
+  {
+    return static_cast<uint32_t>(__builtin_ctz(m));
+  }
+
+#ifdef __SSE2__
+  uint32_t Match(size_t group, int8_t ctrl) const
+  {
+    const auto bytes = _mm_load_si128(
+        reinterpret_cast<const __m128i *>(_ctrl + group));
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(ctrl))));
+  }
+  // Empty and deleted bytes are the negative ones.
+  uint32_t MatchFree(size_t group) const
+  {
+    return static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_load_si128(reinterpret_cast<const __m128i *>(_ctrl + group))));
+  }
+#else
+  uint32_t Match(size_t group, int8_t ctrl) const
+  {
+    uint32_t m = 0;
+    for (size_t i = 0; i < kGroupSize; ++i) {
+      m |= static_cast<uint32_t>(_ctrl[group + i] == ctrl) << i;
+    }
+    return m;
+  }
+  uint32_t MatchFree(size_t group) const
+  {
+    uint32_t m = 0;
+    for (size_t i = 0; i < kGroupSize; ++i) {
+      m |= static_cast<uint32_t>(_ctrl[group + i] < 0) << i;
+    }
+    return m;
+  }
+#endif
+  uint32_t MatchEmpty(size_t group) const { return Match(group, kEmpty); }
+  uint32_t MatchFull(size_t group) const { return ~MatchFree(group) & 0xFFFF; }
+
+  size_t Find(void *key, size_t hash) const
+  {
+    const size_t mask = _capacity - 1;
+    size_t group = (H1(hash) * kGroupSize) & mask;
+    for (size_t step = kGroupSize;; step += kGroupSize) {
+      for (uint32_t m = Match(group, H2(hash)); m != 0; m &= m - 1) {
+        const size_t i = group + Ctz(m);
+        if (_eq(_slots[i].key, key)) {
+          return i;
+        }
+      }
+      if (MatchEmpty(group) != 0) {
+        return kNotFound;
+      }
+      group = (group + step) & mask;
+    }
+  }
+
+  size_t FindFree(size_t hash) const
+  {
+    const size_t mask = _capacity - 1;
+    size_t group = (H1(hash) * kGroupSize) & mask;
+    for (size_t step = kGroupSize;; step += kGroupSize) {
+      const uint32_t m = MatchFree(group);
+      if (m != 0) {
+        return group + Ctz(m);
+      }
+      group = (group + step) & mask;
+    }
+  }
+
+  void Allocate(size_t capacity)
+  {
+    _capacity = capacity;
+    _ctrl = static_cast<int8_t *>(std::aligned_alloc(kGroupSize, capacity));
+    std::memset(_ctrl, kEmpty, capacity);
+    _slots = static_cast<Slot *>(std::malloc(capacity * sizeof(Slot)));
+  }
+
+  void Rehash(size_t capacity)
+  {
+    int8_t *ctrl = _ctrl;
+    Slot *slots = _slots;
+    const size_t old_capacity = _capacity;
+    Allocate(capacity);
+    _deleted = 0;
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (ctrl[i] >= 0) {
+        const size_t hash = Mix(_hash(slots[i].key));
+        const size_t j = FindFree(hash);
+        _ctrl[j] = H2(hash);
+        _slots[j] = slots[i];
+      }
+    }
+    std::free(ctrl);
+    std::free(slots);
+  }
+
+  int8_t *_ctrl = nullptr;
+  Slot *_slots = nullptr;
+  size_t _capacity = 0;
+  size_t _size = 0;
+  size_t _deleted = 0;
+  Hash _hash;
+  Equal _eq;
+};
@@ -0,0 +1,224 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+extern "C" {
+#include <cdcontainers/cdc.h>
+}
+
+#include <algorithm>
+#include <cstddef>
+
+// Lookups of many keys interleaved in the style of AMAC (asynchronous memory
+// access chaining): a group of lookups is in flight at once, each one a small
+// state machine that prefetches the node it needs next and yields, so the
+// cache misses of one lookup overlap with the work of the others instead of
+// stalling one lookup at a time.
+//
+// A cursor walks one container:
+//   void Start(Container *c, int key);  // Prefetches the first load.
+//   bool Step();   // Does the work of one load, prefetches the next one and
+//                  // returns false once the lookup has ended.
+//   bool Found() const;
+
+constexpr size_t kMaxInterleave = 64;
+
+// Looks up keys[0], ..., keys[count - 1] with `group` lookups in flight (up to
+// kMaxInterleave) and returns how many were found.
+template <class Cursor, class Container>
+size_t InterleavedFind(Container *c, const int *keys, size_t count,
+                       size_t group)
+{
+  Cursor cursors[kMaxInterleave];
+  bool active[kMaxInterleave] = {};
+  group = std::min(group, kMaxInterleave);
+  size_t next = 0;
+  size_t running = 0;
+  for (; running < group && next < count; ++running) {
+    cursors[running].Start(c, keys[next++]);
+    active[running] = true;
+  }
+
+  size_t found = 0;
+  while (running > 0) {
+    for (size_t i = 0; i < group; ++i) {
+      if (!active[i] || cursors[i].Step()) {
+        continue;
+      }
+      found += cursors[i].Found();
+      if (next < count) {
+        cursors[i].Start(c, keys[next++]);
+      } else {
+        active[i] = false;
+        --running;
+      }
+    }
+  }
+  return found;
+}
+
+// Walks a chain of cdc_hash_table: the bucket points to the entry before the
+// first one of the chain, which ends at an entry of another bucket.
+class CdcHashTableCursor
+{
+ public:
+  void Start(struct cdc_hash_table *table, int key)
+  {
+    _table = table;
+    _key = CDC_FROM_INT(key);
+    _hash = table->dinfo->hash(_key);
+    _bucket = _hash % table->bcount;
+    _prev = nullptr;
+    _entry = nullptr;
+    _found = false;
+    __builtin_prefetch(&table->buckets[_bucket]);
+  }
+
+  bool Step()
+  {
+    if (_prev == nullptr) {
+      // The entry before the chain belongs to another bucket, so it is a
+      // load of its own before the first entry of the chain.
+      _prev = _table->buckets[_bucket];
+      if (_prev == nullptr) {
+        return false;
+      }
+      __builtin_prefetch(_prev);
+      return true;
+    }
+    if (_entry == nullptr) {
+      return Next(_prev->next);
+    }
+    if (_entry->hash % _table->bcount != _bucket) {
+      return false;
+    }
+    if (_entry->hash == _hash && _table->dinfo->eq(_entry->key, _key)) {
+      _found = true;
+      return false;
+    }
+    return Next(_entry->next);
+  }
+
+  bool Found() const { return _found; }
+
+ private:
+  bool Next(struct cdc_hash_table_entry *entry)
+  {
+    if (entry == nullptr) {
+      return false;
+    }
+    _entry = entry;
+    __builtin_prefetch(entry);
+    return true;
+  }
+
+  struct cdc_hash_table *_table;
+  void *_key;
+  size_t _hash;
+  size_t _bucket;
+  struct cdc_hash_table_entry *_prev;
+  struct cdc_hash_table_entry *_entry;
+  bool _found;
+};
+
+// Walks cdc_avl_tree from the root, one level per step.
+class CdcAvlTreeCursor
+{
+ public:
+  void Start(struct cdc_avl_tree *tree, int key)
+  {
+    _tree = tree;
+    _key = CDC_FROM_INT(key);
+    _node = tree->root;
+    _found = false;
+    __builtin_prefetch(_node);
+  }
+
+  bool Step()
+  {
+    if (_node == nullptr) {
+      return false;
+    }
+    if (_tree->dinfo->cmp(_key, _node->key)) {
+      _node = _node->left;
+    } else if (_tree->dinfo->cmp(_node->key, _key)) {
+      _node = _node->right;
+    } else {
+      _found = true;
+      return false;
+    }
+    __builtin_prefetch(_node);
+    return true;
+  }
+
+  bool Found() const { return _found; }
+
+ private:
+  struct cdc_avl_tree *_tree;
+  void *_key;
+  struct cdc_avl_tree_node *_node;
+  bool _found;
+};
+
+// Walks a bucket of std::unordered_map through its bucket interface. The
+// bucket array has no public address, so only the nodes are prefetched: the
+// first step loads the bucket without overlap.
+template <class Map>
+class CppUnorderedMapCursor
+{
+ public:
+  void Start(Map *map, int key)
+  {
+    _map = map;
+    _key = key;
+    _bucket = map->bucket(key);
+    _started = false;
+    _found = false;
+  }
+
+  bool Step()
+  {
+    if (!_started) {
+      _started = true;
+      _it = _map->begin(_bucket);
+    } else if (_it->first == _key) {
+      _found = true;
+      return false;
+    } else {
+      ++_it;
+    }
+    if (_it == _map->end(_bucket)) {
+      return false;
+    }
+    __builtin_prefetch(&*_it);
+    return true;
+  }
+
+  bool Found() const { return _found; }
+
+ private:
+  Map *_map;
+  int _key;
+  size_t _bucket;
+  typename Map::local_iterator _it;
+  bool _started;
+  bool _found;
+};
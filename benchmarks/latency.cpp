@@ -0,0 +1,67 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#include "benchmarks/latency.hpp"
+
+#include "benchmarks/utils.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+void LatencySizes(benchmark::internal::Benchmark *benchmark)
+{
+  for (auto n : Sizes()) {
+    int shift = 0;
+    while ((int64_t{1} << shift) < n) {
+      ++shift;
+    }
+    if (shift >= 11 && (shift - 11) % 3 == 0) {
+      benchmark->Arg(n);
+    }
+  }
+}
+
+LatencySamples::LatencySamples()
+    : _samples(kCapacity), _gen(MakeRandomEngine({kLatencySamplesTag}))
+{
+}
+
+void LatencySamples::Report(benchmark::State &state)
+{
+  const auto count = static_cast<size_t>(std::min<uint64_t>(_seen, kCapacity));
+  if (count == 0) {
+    return;
+  }
+
+  auto begin = std::begin(_samples);
+  auto end = begin + static_cast<std::ptrdiff_t>(count);
+  std::sort(begin, end);
+  auto percentile = [&](double p) {
+    const auto rank =
+        static_cast<size_t>(p / 100.0 * static_cast<double>(count));
+    return static_cast<double>(_samples[std::min(rank, count - 1)]);
+  };
+  state.counters["p50"] = percentile(50);
+  state.counters["p90"] = percentile(90);
+  state.counters["p99"] = percentile(99);
+  state.counters["p99.9"] = percentile(99.9);
+  state.counters["max"] = static_cast<double>(_max);
+}
@@ -0,0 +1,111 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include "benchmarks/pool_alloc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Sizes of the latency benchmarks: every operation is timed on its own, so a
+// few sizes from the caches to memory are enough for the tails: 1 << 11,
+// 1 << 14 and every third power of two of Sizes() after them.
+void LatencySizes(benchmark::internal::Benchmark *benchmark);
+
+#define S_LATENCY(benchmark) benchmark->Apply(LatencySizes)->UseManualTime()
+
+// Latencies of single operations in nanoseconds, kept in a buffer allocated
+// up front so that sampling allocates nothing. Once the buffer is full, new
+// samples replace kept ones at random (reservoir sampling), so the kept
+// samples stay a uniform sample of all operations. The maximum is tracked
+// over all samples, since the reservoir may have dropped the slowest one.
+class LatencySamples
+{
+ public:
+  static constexpr size_t kCapacity = 1 << 20;
+
+  LatencySamples();
+
+  void Add(uint64_t ns)
+  {
+    _max = std::max(_max, ns);
+    if (_seen < kCapacity) {
+      _samples[_seen] = ns;
+    } else {
+      std::uniform_int_distribution<uint64_t> dis(0, _seen);
+      const uint64_t i = dis(_gen);
+      if (i < kCapacity) {
+        _samples[i] = ns;
+      }
+    }
+    ++_seen;
+  }
+
+  // Sets the p50, p90, p99, p99.9 and max counters in nanoseconds.
+  void Report(benchmark::State &state);
+
+ private:
+  std::vector<uint64_t> _samples;
+  uint64_t _seen = 0;
+  uint64_t _max = 0;
+  std::mt19937_64 _gen;
+};
+
+// Runs state.range(0) operations `op(container, i)` on a container made by
+// `ctor` and released by `dtor` per iteration, and reads the clock
+// (clock_gettime(CLOCK_MONOTONIC) through the vDSO) around every operation.
+// The iteration time is the sum of the operation times, so the mean stays
+// comparable with RunBatched, and the percentiles of the operation times are
+// reported as counters. The clock reads add a few tens of nanoseconds to every
+// sample. The benchmark must be registered with UseManualTime(), as S_LATENCY
+// does. `ctor` and `op` allocate from the pool when one is set with --pool.
+template <typename Ctor, typename Op, typename Dtor>
+void RunSampled(benchmark::State &state, Ctor &&ctor, Op &&op, Dtor &&dtor)
+{
+  using Clock = std::chrono::steady_clock;
+  const auto n = static_cast<size_t>(state.range(0));
+  LatencySamples samples;
+  for (auto _ : state) {
+    const PoolScope scope;
+    auto c = ctor();
+    uint64_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+      auto start = Clock::now();
+      op(c, i);
+      auto end = Clock::now();
+      const auto ns = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+              .count());
+      samples.Add(ns);
+      total += ns;
+    }
+    state.SetIterationTime(static_cast<double>(total) * 1e-9);
+    dtor(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  samples.Report(state);
+}
@@ -0,0 +1,629 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+extern "C" {
+#include <cdcontainers/cdc.h>
+#include <collectc/hashtable.h>
+#include <collectc/treetable.h>
+#include <gmodule.h>
+}
+
+#include "benchmarks/utils.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// Every map competitor behind the same int-key interface, for workloads that
+// run one operation sequence against all of them:
+//   void Insert(int key);
+//   void Erase(int key);
+//   bool Find(int key);
+//   void ForEach(Fn fn);  // fn(key) for every key, in iteration order.
+// Values are always null, as in the other map benchmarks.
+//
+// Ordered maps also have:
+//   bool LowerBound(int key, int *bound);  // The least key >= key, if any.
+//   bool UpperBound(int key, int *bound);  // The least key > key, if any.
+//   void Scan(int from, int to, Fn fn);    // fn(key) for keys in [from, to).
+// cdcontainers and Collections-C only look up keys that are in the map. The
+// cdcontainers AVL trees and treaps are descended through their public node
+// structs instead, as GTree is through g_tree_search(). Collections-C TreeTable
+// and the cdcontainers splay tree, which would have to splay, have no
+// LowerBound, and their UpperBound and Scan find nothing unless `key` and
+// `from` are in the map.
+//
+// Hash tables but GHashTable, which sizes itself, also have a constructor from
+// the max load factor and the number of keys to make room for (0 keeps the
+// default of the library for either), and
+//   size_t BucketCount();
+
+// The node of `tree` holding the least key not less than `key` (greater than
+// `key` if `strict`), found by a root-to-leaf descent with the comparator of
+// the tree, or null. Works for the cdcontainers trees of plain binary search
+// tree nodes: cdc_avl_tree and cdc_treap.
+template <class Tree>
+auto CdcBoundNode(const Tree *tree, int key, bool strict)
+{
+  void *k = CDC_FROM_INT(key);
+  decltype(tree->root) bound = nullptr;
+  for (auto node = tree->root; node != nullptr;) {
+    if (strict ? tree->dinfo->cmp(k, node->key)
+               : !tree->dinfo->cmp(node->key, k)) {
+      bound = node;
+      node = node->left;
+    } else {
+      node = node->right;
+    }
+  }
+  return bound;
+}
+
+// The in-order successor of `node` through the parent links, or null.
+template <class Node>
+Node *CdcNextNode(Node *node)
+{
+  if (node->right != nullptr) {
+    node = node->right;
+    while (node->left != nullptr) {
+      node = node->left;
+    }
+    return node;
+  }
+  while (node->parent != nullptr && node == node->parent->right) {
+    node = node->parent;
+  }
+  return node->parent;
+}
+
+template <class Tree>
+bool CdcBound(const Tree *tree, int key, bool strict, int *bound)
+{
+  auto node = CdcBoundNode(tree, key, strict);
+  if (node == nullptr) {
+    return false;
+  }
+  *bound = CDC_TO_INT(node->key);
+  return true;
+}
+
+template <class Tree, typename Fn>
+void CdcScan(const Tree *tree, int from, int to, Fn &&fn)
+{
+  for (auto node = CdcBoundNode(tree, from, false);
+       node != nullptr && CDC_TO_INT(node->key) < to;
+       node = CdcNextNode(node)) {
+    fn(CDC_TO_INT(node->key));
+  }
+}
+
+template <class Container>
+class CppMap
+{
+ public:
+  CppMap() = default;
+  CppMap(float max_load_factor, size_t count)
+  {
+    if (max_load_factor > 0) {
+      _c.max_load_factor(max_load_factor);
+    }
+    if (count > 0) {
+      _c.reserve(count);
+    }
+  }
+
+  void Insert(int key) { _c.emplace(key, nullptr); }
+  void Erase(int key) { _c.erase(key); }
+  bool Find(int key) { return _c.find(key) != std::end(_c); }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    for (const auto &kv : _c) {
+      fn(kv.first);
+    }
+  }
+
+  size_t BucketCount() const { return _c.bucket_count(); }
+
+  bool LowerBound(int key, int *bound)
+  {
+    return Bound(_c.lower_bound(key), bound);
+  }
+  bool UpperBound(int key, int *bound)
+  {
+    return Bound(_c.upper_bound(key), bound);
+  }
+
+  template <typename Fn>
+  void Scan(int from, int to, Fn &&fn)
+  {
+    for (auto it = _c.lower_bound(from); it != std::end(_c) && it->first < to;
+         ++it) {
+      fn(it->first);
+    }
+  }
+
+ private:
+  template <typename It>
+  bool Bound(It it, int *bound)
+  {
+    if (it == std::end(_c)) {
+      return false;
+    }
+    *bound = it->first;
+    return true;
+  }
+
+  Container _c;
+};
+
+class CcHashTableMap
+{
+ public:
+  CcHashTableMap() : CcHashTableMap(0, 0) {}
+  // Collections-C reserves room only through the initial capacity.
+  CcHashTableMap(float max_load_factor, size_t count)
+  {
+    HashTableConf conf;
+    hashtable_conf_init(&conf);
+    conf.key_compare = IsEquil;
+    conf.hash = CcHash;
+    if (max_load_factor > 0) {
+      conf.load_factor = max_load_factor;
+    }
+    if (count > 0) {
+      conf.initial_capacity = static_cast<size_t>(
+          std::ceil(static_cast<float>(count) / conf.load_factor));
+    }
+    hashtable_new_conf(&conf, &_table);
+  }
+  ~CcHashTableMap() { hashtable_destroy(_table); }
+
+  CcHashTableMap(const CcHashTableMap &) = delete;
+  CcHashTableMap &operator=(const CcHashTableMap &) = delete;
+
+  void Insert(int key) { hashtable_add(_table, CDC_FROM_INT(key), nullptr); }
+  void Erase(int key) { hashtable_remove(_table, CDC_FROM_INT(key), nullptr); }
+  bool Find(int key)
+  {
+    void *value = nullptr;
+    return hashtable_get(_table, CDC_FROM_INT(key), &value) == CC_OK;
+  }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    HashTableIter it;
+    hashtable_iter_init(&it, _table);
+    TableEntry *entry;
+    while (hashtable_iter_next(&it, &entry) != CC_ITER_END) {
+      fn(CDC_TO_INT(entry->key));
+    }
+  }
+
+  size_t BucketCount() { return hashtable_capacity(_table); }
+
+ private:
+  HashTable *_table = nullptr;
+};
+
+class CcTreeTableMap
+{
+ public:
+  CcTreeTableMap()
+  {
+    TreeTableConf conf;
+    treetable_conf_init(&conf);
+    conf.cmp = CcCmp;
+    treetable_new_conf(&conf, &_table);
+  }
+  ~CcTreeTableMap() { treetable_destroy(_table); }
+
+  CcTreeTableMap(const CcTreeTableMap &) = delete;
+  CcTreeTableMap &operator=(const CcTreeTableMap &) = delete;
+
+  void Insert(int key) { treetable_add(_table, CDC_FROM_INT(key), nullptr); }
+  void Erase(int key) { treetable_remove(_table, CDC_FROM_INT(key), nullptr); }
+  bool Find(int key)
+  {
+    void *value = nullptr;
+    return treetable_get(_table, CDC_FROM_INT(key), &value) == CC_OK;
+  }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    TreeTableIter it;
+    treetable_iter_init(&it, _table);
+    TreeTableEntry entry;
+    while (treetable_iter_next(&it, &entry) != CC_ITER_END) {
+      fn(CDC_TO_INT(entry.key));
+    }
+  }
+
+  bool UpperBound(int key, int *bound)
+  {
+    void *next = nullptr;
+    if (treetable_get_greater_than(_table, CDC_FROM_INT(key), &next) !=
+        CC_OK) {
+      return false;
+    }
+    *bound = CDC_TO_INT(next);
+    return true;
+  }
+
+  template <typename Fn>
+  void Scan(int from, int to, Fn &&fn)
+  {
+    if (!Find(from)) {
+      return;
+    }
+    for (int key = from; key < to;) {
+      fn(key);
+      if (!UpperBound(key, &key)) {
+        break;
+      }
+    }
+  }
+
+ private:
+  TreeTable *_table = nullptr;
+};
+
+class GTreeMap
+{
+ public:
+  GTreeMap() : _tree(g_tree_new(CcCmp)) {}
+  ~GTreeMap() { g_tree_destroy(_tree); }
+
+  GTreeMap(const GTreeMap &) = delete;
+  GTreeMap &operator=(const GTreeMap &) = delete;
+
+  void Insert(int key) { g_tree_insert(_tree, CDC_FROM_INT(key), nullptr); }
+  void Erase(int key) { g_tree_remove(_tree, CDC_FROM_INT(key)); }
+  bool Find(int key)
+  {
+    void *orig_key = nullptr;
+    void *value = nullptr;
+    return g_tree_lookup_extended(_tree, CDC_FROM_INT(key), &orig_key, &value);
+  }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    g_tree_foreach(_tree, Visit<std::remove_reference_t<Fn>>, &fn);
+  }
+
+  // glib 2.63 has no bound lookups, but g_tree_search() descends by the sign
+  // of the search function: one that never matches walks a root-to-leaf path
+  // and remembers the last key that satisfied the bound.
+  bool LowerBound(int key, int *bound)
+  {
+    Bound lower = {key, false, false, 0};
+    g_tree_search(_tree, SearchBound, &lower);
+    *bound = lower.bound;
+    return lower.found;
+  }
+
+  bool UpperBound(int key, int *bound)
+  {
+    Bound upper = {key, true, false, 0};
+    g_tree_search(_tree, SearchBound, &upper);
+    *bound = upper.bound;
+    return upper.found;
+  }
+
+  template <typename Fn>
+  void Scan(int from, int to, Fn &&fn)
+  {
+    int key = 0;
+    for (bool found = LowerBound(from, &key); found && key < to;
+         found = UpperBound(key, &key)) {
+      fn(key);
+    }
+  }
+
+ private:
+  struct Bound {
+    int key;
+    bool strict;
+    bool found;
+    int bound;
+  };
+
+  template <typename Fn>
+  static gboolean Visit(gpointer key, gpointer /* value */, gpointer data)
+  {
+    (*static_cast<Fn *>(data))(CDC_TO_INT(key));
+    return FALSE;
+  }
+
+  static gint SearchBound(gconstpointer node_key, gconstpointer data)
+  {
+    auto b = static_cast<Bound *>(const_cast<gpointer>(data));
+    const int k = CDC_TO_INT(node_key);
+    if (b->strict ? k > b->key : k >= b->key) {
+      b->found = true;
+      b->bound = k;
+      return -1;
+    }
+    return 1;
+  }
+
+  GTree *_tree;
+};
+
+class GHashTableMap
+{
+ public:
+  GHashTableMap() : _table(g_hash_table_new(GHash, IsEquil)) {}
+  ~GHashTableMap() { g_hash_table_destroy(_table); }
+
+  GHashTableMap(const GHashTableMap &) = delete;
+  GHashTableMap &operator=(const GHashTableMap &) = delete;
+
+  void Insert(int key)
+  {
+    g_hash_table_insert(_table, CDC_FROM_INT(key), nullptr);
+  }
+  void Erase(int key) { g_hash_table_remove(_table, CDC_FROM_INT(key)); }
+  bool Find(int key)
+  {
+    void *orig_key = nullptr;
+    void *value = nullptr;
+    return g_hash_table_lookup_extended(_table, CDC_FROM_INT(key), &orig_key,
+                                        &value);
+  }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    GHashTableIter it;
+    g_hash_table_iter_init(&it, _table);
+    void *key;
+    void *value;
+    while (g_hash_table_iter_next(&it, &key, &value)) {
+      fn(CDC_TO_INT(key));
+    }
+  }
+
+ private:
+  GHashTable *_table;
+};
+
+class CdcMap
+{
+ public:
+  explicit CdcMap(const struct cdc_map_table *table)
+  {
+    _info.eq = IsEquil;
+    _info.cmp = Less;
+    _info.hash = Hash;
+    cdc_map_ctor(table, &_map, &_info);
+  }
+  ~CdcMap() { cdc_map_dtor(_map); }
+
+  CdcMap(const CdcMap &) = delete;
+  CdcMap &operator=(const CdcMap &) = delete;
+
+  void Insert(int key)
+  {
+    cdc_map_insert(_map, CDC_FROM_INT(key), nullptr, nullptr, nullptr);
+  }
+  void Erase(int key) { cdc_map_erase(_map, CDC_FROM_INT(key)); }
+  bool Find(int key)
+  {
+    void *value = nullptr;
+    return cdc_map_get(_map, CDC_FROM_INT(key), &value) == CDC_STATUS_OK;
+  }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    cdc_map_iter it;
+    cdc_map_iter_ctor(_map, &it);
+    cdc_map_begin(_map, &it);
+    while (cdc_map_iter_has_next(&it)) {
+      fn(CDC_TO_INT(cdc_map_iter_key(&it)));
+      cdc_map_iter_next(&it);
+    }
+    cdc_map_iter_dtor(&it);
+  }
+
+  // For AVL trees and treaps only.
+  bool LowerBound(int key, int *bound)
+  {
+    if (_map->table == cdc_map_avl) {
+      return CdcBound(AvlTree(), key, false, bound);
+    }
+    return CdcBound(Treap(), key, false, bound);
+  }
+
+  bool UpperBound(int key, int *bound)
+  {
+    if (_map->table == cdc_map_avl) {
+      return CdcBound(AvlTree(), key, true, bound);
+    } else if (_map->table == cdc_map_treap) {
+      return CdcBound(Treap(), key, true, bound);
+    }
+    cdc_map_iter it;
+    cdc_map_iter_ctor(_map, &it);
+    cdc_map_find(_map, CDC_FROM_INT(key), &it);
+    bool found = false;
+    if (cdc_map_iter_has_next(&it)) {
+      cdc_map_iter_next(&it);
+      if (cdc_map_iter_has_next(&it)) {
+        *bound = CDC_TO_INT(cdc_map_iter_key(&it));
+        found = true;
+      }
+    }
+    cdc_map_iter_dtor(&it);
+    return found;
+  }
+
+  template <typename Fn>
+  void Scan(int from, int to, Fn &&fn)
+  {
+    if (_map->table == cdc_map_avl) {
+      CdcScan(AvlTree(), from, to, fn);
+      return;
+    } else if (_map->table == cdc_map_treap) {
+      CdcScan(Treap(), from, to, fn);
+      return;
+    }
+    cdc_map_iter it;
+    cdc_map_iter_ctor(_map, &it);
+    cdc_map_find(_map, CDC_FROM_INT(from), &it);
+    while (cdc_map_iter_has_next(&it)) {
+      const int key = CDC_TO_INT(cdc_map_iter_key(&it));
+      if (key >= to) {
+        break;
+      }
+      fn(key);
+      cdc_map_iter_next(&it);
+    }
+    cdc_map_iter_dtor(&it);
+  }
+
+ private:
+  const struct cdc_avl_tree *AvlTree() const
+  {
+    return static_cast<const struct cdc_avl_tree *>(_map->container);
+  }
+  const struct cdc_treap *Treap() const
+  {
+    return static_cast<const struct cdc_treap *>(_map->container);
+  }
+
+  struct cdc_data_info _info = {};
+  struct cdc_map *_map = nullptr;
+};
+
+class CdcHashTableMap
+{
+ public:
+  CdcHashTableMap() : CdcHashTableMap(0, 0) {}
+  CdcHashTableMap(float max_load_factor, size_t count)
+  {
+    _info.eq = IsEquil;
+    _info.hash = Hash;
+    if (max_load_factor > 0) {
+      cdc_hash_table_ctor1(&_table, &_info, max_load_factor);
+    } else {
+      cdc_hash_table_ctor(&_table, &_info);
+    }
+    if (count > 0) {
+      cdc_hash_table_reserve(_table, count);
+    }
+  }
+  ~CdcHashTableMap() { cdc_hash_table_dtor(_table); }
+
+  CdcHashTableMap(const CdcHashTableMap &) = delete;
+  CdcHashTableMap &operator=(const CdcHashTableMap &) = delete;
+
+  void Insert(int key)
+  {
+    cdc_hash_table_insert(_table, CDC_FROM_INT(key), nullptr, nullptr,
+                          nullptr);
+  }
+  void Erase(int key) { cdc_hash_table_erase(_table, CDC_FROM_INT(key)); }
+  bool Find(int key)
+  {
+    void *value = nullptr;
+    return cdc_hash_table_get(_table, CDC_FROM_INT(key), &value) ==
+           CDC_STATUS_OK;
+  }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    cdc_hash_table_iter it;
+    cdc_hash_table_begin(_table, &it);
+    while (cdc_hash_table_iter_has_next(&it)) {
+      fn(CDC_TO_INT(cdc_hash_table_iter_key(&it)));
+      cdc_hash_table_iter_next(&it);
+    }
+  }
+
+  size_t BucketCount() { return cdc_hash_table_bucket_count(_table); }
+
+ private:
+  struct cdc_data_info _info = {};
+  struct cdc_hash_table *_table = nullptr;
+};
+
+class CdcAvlTreeMap
+{
+ public:
+  CdcAvlTreeMap()
+  {
+    _info.cmp = Less;
+    cdc_avl_tree_ctor(&_tree, &_info);
+  }
+  ~CdcAvlTreeMap() { cdc_avl_tree_dtor(_tree); }
+
+  CdcAvlTreeMap(const CdcAvlTreeMap &) = delete;
+  CdcAvlTreeMap &operator=(const CdcAvlTreeMap &) = delete;
+
+  void Insert(int key)
+  {
+    cdc_avl_tree_insert1(_tree, CDC_FROM_INT(key), nullptr, nullptr, nullptr);
+  }
+  void Erase(int key) { cdc_avl_tree_erase(_tree, CDC_FROM_INT(key)); }
+  bool Find(int key)
+  {
+    void *value = nullptr;
+    return cdc_avl_tree_get(_tree, CDC_FROM_INT(key), &value) == CDC_STATUS_OK;
+  }
+
+  template <typename Fn>
+  void ForEach(Fn &&fn)
+  {
+    cdc_avl_tree_iter it;
+    cdc_avl_tree_begin(_tree, &it);
+    while (cdc_avl_tree_iter_has_next(&it)) {
+      fn(CDC_TO_INT(cdc_avl_tree_iter_key(&it)));
+      cdc_avl_tree_iter_next(&it);
+    }
+  }
+
+  bool LowerBound(int key, int *bound)
+  {
+    return CdcBound(_tree, key, false, bound);
+  }
+
+  bool UpperBound(int key, int *bound)
+  {
+    return CdcBound(_tree, key, true, bound);
+  }
+
+  template <typename Fn>
+  void Scan(int from, int to, Fn &&fn)
+  {
+    CdcScan(_tree, from, to, fn);
+  }
+
+ private:
+  struct cdc_data_info _info = {};
+  struct cdc_avl_tree *_tree = nullptr;
+};
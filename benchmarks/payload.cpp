@@ -0,0 +1,178 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#include "benchmarks/payload.hpp"
+
+extern "C" {
+#include <cdcontainers/cdc.h>
+}
+
+#include "benchmarks/utils.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+void FreeValuePair(void *pair)
+{
+  std::free(static_cast<cdc_pair *>(pair)->second);
+}
+
+void FreeOwnedPair(void *pair)
+{
+  std::free(static_cast<cdc_pair *>(pair)->first);
+  std::free(static_cast<cdc_pair *>(pair)->second);
+}
+
+int StringDataCmp(const void *lhs, const void *rhs, void * /* data */)
+{
+  return StringCmp(lhs, rhs);
+}
+
+int IntDataCmp(const void *lhs, const void *rhs, void * /* data */)
+{
+  return CcCmp(lhs, rhs);
+}
+
+}  // namespace
+
+Payload::Payload(size_t count, size_t key_size, size_t value_size)
+    : _key_size(key_size), _value_size(value_size)
+{
+  const RandomSet rs(count);
+  _ints.reserve(count);
+  rs.ForEach([&](auto v) { _ints.push_back(v); });
+  if (_key_size == 0) {
+    return;
+  }
+
+  _strings.resize(count * _key_size);
+  for (size_t i = 0; i < count; ++i) {
+    std::snprintf(_strings.data() + i * _key_size, _key_size, "%0*d",
+                  static_cast<int>(_key_size - 1), _ints[i]);
+  }
+}
+
+void *Payload::Key(size_t i) const
+{
+  return StringKeys() ? const_cast<char *>(StringKey(i))
+                      : CDC_FROM_INT(_ints[i]);
+}
+
+void *Payload::MakeKey(size_t i) const
+{
+  if (!StringKeys()) {
+    return CDC_FROM_INT(_ints[i]);
+  }
+
+  void *key = std::malloc(_key_size);
+  std::memcpy(key, StringKey(i), _key_size);
+  return key;
+}
+
+void *Payload::MakeValue(size_t i) const
+{
+  if (_value_size == 0) {
+    return nullptr;
+  }
+
+  void *value = std::malloc(_value_size);
+  std::memset(value, _ints[i], _value_size);
+  return value;
+}
+
+void *Payload::MakeElement(size_t i) const
+{
+  return StringKeys() ? MakeKey(i) : MakeValue(i);
+}
+
+Payload::Pred Payload::Less() const
+{
+  return StringKeys() ? StringLess : ::Less;
+}
+
+Payload::Pred Payload::Cmp() const
+{
+  return StringKeys() ? StringCmp : CcCmp;
+}
+
+Payload::GDataCmpFn Payload::GDataCmp() const
+{
+  return StringKeys() ? StringDataCmp : IntDataCmp;
+}
+
+Payload::Pred Payload::Equil() const
+{
+  return StringKeys() ? StringEquil : IsEquil;
+}
+
+Payload::HashFn Payload::Hash() const
+{
+  return StringKeys() ? StringHash : ::Hash;
+}
+
+Payload::GHashFn Payload::GHash() const
+{
+  return StringKeys() ? GStringHash : ::GHash;
+}
+
+Payload::FreeFn Payload::PairFree() const
+{
+  return StringKeys() ? FreeOwnedPair : FreeValuePair;
+}
+
+Payload::FreeFn Payload::KeyFree() const
+{
+  return StringKeys() ? std::free : nullptr;
+}
+
+int StringLess(const void *lhs, const void *rhs)
+{
+  return std::strcmp(static_cast<const char *>(lhs),
+                     static_cast<const char *>(rhs)) < 0;
+}
+
+int StringCmp(const void *lhs, const void *rhs)
+{
+  return std::strcmp(static_cast<const char *>(lhs),
+                     static_cast<const char *>(rhs));
+}
+
+int StringEquil(const void *lhs, const void *rhs)
+{
+  return std::strcmp(static_cast<const char *>(lhs),
+                     static_cast<const char *>(rhs)) == 0;
+}
+
+size_t StringHash(const void *key)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (auto s = static_cast<const unsigned char *>(key); *s != 0; ++s) {
+    hash = (hash ^ *s) * 1099511628211ULL;
+  }
+  return static_cast<size_t>(hash);
+}
+
+unsigned int GStringHash(const void *key)
+{
+  return static_cast<unsigned int>(StringHash(key));
+}
@@ -0,0 +1,87 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Keys and values of payload benchmarks. Keys are the distinct values of a
+// RandomSet, either boxed ints (key_size == 0) or zero-padded decimal strings
+// of key_size bytes with the terminating zero, so that strings of one size
+// share long prefixes and compare as their ints do. Values are heap structs of
+// value_size bytes, or nullptr if value_size == 0.
+class Payload
+{
+ public:
+  using Pred = int (*)(const void *, const void *);
+  using HashFn = size_t (*)(const void *);
+  using GHashFn = unsigned int (*)(const void *);
+  using GDataCmpFn = int (*)(const void *, const void *, void *);
+  using FreeFn = void (*)(void *);
+
+  Payload(size_t count, size_t key_size, size_t value_size);
+
+  size_t Size() const { return _ints.size(); }
+  size_t KeySize() const { return _key_size; }
+  size_t ValueSize() const { return _value_size; }
+  bool StringKeys() const { return _key_size != 0; }
+
+  int IntKey(size_t i) const { return _ints[i]; }
+  const char *StringKey(size_t i) const
+  {
+    return _strings.data() + i * _key_size;
+  }
+
+  // The i-th key for lookups, owned by the payload.
+  void *Key(size_t i) const;
+  // Heap copies that the container owns and frees with the callbacks below.
+  void *MakeKey(size_t i) const;
+  void *MakeValue(size_t i) const;
+  // Sequences hold the key string, or the value struct with int keys.
+  void *MakeElement(size_t i) const;
+
+  // Callbacks that match the key kind.
+  Pred Less() const;
+  // Three-way comparison, as CcCmp.
+  Pred Cmp() const;
+  // Cmp() with the user data argument of g_tree_new_full().
+  GDataCmpFn GDataCmp() const;
+  Pred Equil() const;
+  HashFn Hash() const;
+  GHashFn GHash() const;
+  // Frees the key (if owned) and the value of a struct cdc_pair.
+  FreeFn PairFree() const;
+  // Frees an owned key, or nullptr for int keys.
+  FreeFn KeyFree() const;
+
+ private:
+  std::vector<int> _ints;
+  std::vector<char> _strings;
+  size_t _key_size;
+  size_t _value_size;
+};
+
+int StringLess(const void *lhs, const void *rhs);
+int StringCmp(const void *lhs, const void *rhs);
+int StringEquil(const void *lhs, const void *rhs);
+// FNV-1a, the same for all competitors.
+size_t StringHash(const void *key);
+unsigned int GStringHash(const void *key);
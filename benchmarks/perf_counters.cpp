@@ -0,0 +1,165 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#include "benchmarks/perf_counters.hpp"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+bool g_enabled = false;
+
+#if defined(__linux__)
+struct Event {
+  const char *name;
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr uint64_t CacheReadMiss(uint64_t cache)
+{
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+const Event kEvents[PerfCounters::kCount] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"l1d_misses", PERF_TYPE_HW_CACHE, CacheReadMiss(PERF_COUNT_HW_CACHE_L1D)},
+    {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"dtlb_misses", PERF_TYPE_HW_CACHE,
+     CacheReadMiss(PERF_COUNT_HW_CACHE_DTLB)},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+int OpenEvent(const Event &event)
+{
+  struct perf_event_attr attr = {};
+  attr.size = sizeof(attr);
+  attr.type = event.type;
+  attr.config = event.config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, &attr, 0 /* this thread */,
+              -1 /* any cpu */, -1 /* no group */, 0));
+}
+#endif
+
+}  // namespace
+
+PerfCounters::PerfCounters() : _start(), _totals()
+{
+  for (auto &fd : _fds) {
+    fd = -1;
+  }
+#if defined(__linux__)
+  if (!g_enabled) {
+    return;
+  }
+
+  bool opened = false;
+  for (size_t i = 0; i < kCount; ++i) {
+    _fds[i] = OpenEvent(kEvents[i]);
+    opened = opened || _fds[i] != -1;
+  }
+
+  static bool warned = false;
+  if (!opened && !warned) {
+    std::fprintf(stderr, "Perf counters are unavailable: %s\n",
+                 std::strerror(errno));
+    warned = true;
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+  for (auto fd : _fds) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+void PerfCounters::Start()
+{
+#if defined(__linux__)
+  for (size_t i = 0; i < kCount; ++i) {
+    if (_fds[i] != -1 && read(_fds[i], &_start[i], sizeof(Value)) == -1) {
+      _start[i] = {};
+    }
+  }
+#endif
+}
+
+void PerfCounters::Stop()
+{
+#if defined(__linux__)
+  for (size_t i = 0; i < kCount; ++i) {
+    Value end;
+    if (_fds[i] == -1 || read(_fds[i], &end, sizeof(Value)) == -1) {
+      continue;
+    }
+
+    // Events may be multiplexed when the PMU has fewer counters than events,
+    // so the raw count is scaled to the time the event was enabled.
+    double running = static_cast<double>(end.time_running -
+                                         _start[i].time_running);
+    if (running > 0) {
+      double enabled = static_cast<double>(end.time_enabled -
+                                           _start[i].time_enabled);
+      _totals[i] +=
+          static_cast<double>(end.value - _start[i].value) * enabled / running;
+    }
+  }
+#endif
+}
+
+void PerfCounters::Report(benchmark::State &state, double ops) const
+{
+#if defined(__linux__)
+  for (size_t i = 0; i < kCount; ++i) {
+    if (_fds[i] != -1) {
+      state.counters[kEvents[i].name] = benchmark::Counter(
+          _totals[i] / ops, benchmark::Counter::kAvgIterations);
+    }
+  }
+#else
+  (void)state;
+  (void)ops;
+#endif
+}
+
+void EnablePerfCounters(bool enable) { g_enabled = enable; }
+
+bool PerfCountersEnabled() { return g_enabled; }
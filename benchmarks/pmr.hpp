@@ -0,0 +1,57 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <initializer_list>
+#include <list>
+#include <map>
+#include <memory_resource>
+
+// Node-based standard containers that allocate from a memory resource of
+// their own (std::pmr::monotonic_buffer_resource,
+// std::pmr::unsynchronized_pool_resource), with the interface of the plain
+// containers, so benchmarks of the plain containers take them as they are.
+
+template <class Resource>
+struct PmrResource {
+  Resource resource;
+};
+
+// The resource is a base of its own, so it is built before the container and
+// destroyed after it.
+template <class Resource>
+class CppPmrList : private PmrResource<Resource>, public std::pmr::list<int>
+{
+ public:
+  CppPmrList() : std::pmr::list<int>(&this->resource) {}
+  CppPmrList(std::initializer_list<int> values)
+      : std::pmr::list<int>(values, &this->resource)
+  {
+  }
+};
+
+template <class Resource>
+class CppPmrMap : private PmrResource<Resource>,
+                  public std::pmr::map<int, void *>
+{
+ public:
+  CppPmrMap() : std::pmr::map<int, void *>(&this->resource) {}
+};
@@ -0,0 +1,137 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#include "benchmarks/pool_alloc.hpp"
+
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kAlignment = 16;
+constexpr size_t kClasses = 16;
+constexpr size_t kMaxSize = kClasses * kAlignment;
+// Address space reserved per size class. Pages are committed on first touch.
+constexpr size_t kRegionSize = static_cast<size_t>(1) << 30;
+
+struct SizeClass {
+  char *next;
+  void *free_list;
+};
+
+PoolKind g_kind = PoolKind::kNone;
+int g_depth = 0;
+char *g_base = nullptr;
+SizeClass g_classes[kClasses];
+size_t g_live = 0;
+
+char *RegionStart(size_t cls) { return g_base + cls * kRegionSize; }
+
+// Blocks of a class lie in its own region, so the class of a block is known
+// from its address alone.
+size_t ClassOf(const void *ptr)
+{
+  return static_cast<size_t>(static_cast<const char *>(ptr) - g_base) /
+         kRegionSize;
+}
+
+// Starts all classes over once no block is live, so the arena does not grow
+// across batches.
+void Rewind()
+{
+  for (size_t cls = 0; cls < kClasses; ++cls) {
+    g_classes[cls].next = RegionStart(cls);
+    g_classes[cls].free_list = nullptr;
+  }
+}
+
+}  // namespace
+
+void SetPoolKind(PoolKind kind)
+{
+  if (kind != PoolKind::kNone && g_base == nullptr) {
+    void *base = mmap(nullptr, kClasses * kRegionSize, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+      std::fprintf(stderr, "Pool allocator is not available: %s\n",
+                   std::strerror(errno));
+      return;
+    }
+    g_base = static_cast<char *>(base);
+    Rewind();
+  }
+  g_kind = kind;
+}
+
+PoolKind GetPoolKind() { return g_kind; }
+
+PoolScope::PoolScope() { ++g_depth; }
+
+PoolScope::~PoolScope() { --g_depth; }
+
+void *PoolMalloc(size_t size)
+{
+  if (g_kind == PoolKind::kNone || g_depth == 0 || size > kMaxSize) {
+    return nullptr;
+  }
+
+  const size_t cls = size == 0 ? 0 : (size - 1) / kAlignment;
+  SizeClass &sc = g_classes[cls];
+  void *ptr = sc.free_list;
+  if (ptr != nullptr) {
+    sc.free_list = *static_cast<void **>(ptr);
+  } else {
+    const size_t block = (cls + 1) * kAlignment;
+    if (sc.next + block > RegionStart(cls + 1)) {
+      return nullptr;
+    }
+    ptr = sc.next;
+    sc.next += block;
+  }
+  ++g_live;
+  return ptr;
+}
+
+bool PoolOwns(const void *ptr)
+{
+  const auto p = static_cast<const char *>(ptr);
+  return g_base != nullptr && p >= g_base && p < RegionStart(kClasses);
+}
+
+size_t PoolUsableSize(const void *ptr)
+{
+  return (ClassOf(ptr) + 1) * kAlignment;
+}
+
+void PoolFree(void *ptr)
+{
+  if (g_kind == PoolKind::kSizeClass) {
+    SizeClass &sc = g_classes[ClassOf(ptr)];
+    *static_cast<void **>(ptr) = sc.free_list;
+    sc.free_list = ptr;
+  }
+  if (--g_live == 0) {
+    Rewind();
+  }
+}
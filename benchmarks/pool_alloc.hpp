@@ -0,0 +1,56 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+
+enum class PoolKind {
+  kNone,
+  // Blocks are rounded up to size classes of 16 bytes and freed blocks are
+  // reused by their class.
+  kSizeClass,
+  // Blocks are carved off in order and never reused.
+  kBump,
+};
+
+// With a pool set (--pool=size_class or --pool=bump), the malloc family of
+// alloc_stats.cpp serves small allocations made inside a PoolScope from an
+// in-tree allocator instead of glibc. RunBenchmarks() restarts the binary
+// with G_SLICE=always-malloc then, so glib nodes are served too. The pool is
+// not thread-safe and is used only by single-threaded benchmarks.
+void SetPoolKind(PoolKind kind);
+PoolKind GetPoolKind();
+
+class PoolScope
+{
+ public:
+  PoolScope();
+  ~PoolScope();
+
+  PoolScope(const PoolScope &) = delete;
+  PoolScope &operator=(const PoolScope &) = delete;
+};
+
+// Returns nullptr if the pool does not serve the request.
+void *PoolMalloc(size_t size);
+bool PoolOwns(const void *ptr);
+size_t PoolUsableSize(const void *ptr);
+void PoolFree(void *ptr);
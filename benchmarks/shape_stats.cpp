@@ -0,0 +1,91 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#include "benchmarks/shape_stats.hpp"
+
+#include <string>
+
+namespace {
+
+bool g_enabled = false;
+
+}  // namespace
+
+void EnableShapeStats(bool enable) { g_enabled = enable; }
+
+bool ShapeStatsEnabled() { return g_enabled; }
+
+void ShapeCounters::Add(const struct cdc_map *map)
+{
+  if (map->table == cdc_map_htable) {
+    Add(static_cast<const struct cdc_hash_table *>(map->container));
+  } else if (map->table == cdc_map_avl) {
+    Add(static_cast<const struct cdc_avl_tree *>(map->container));
+  } else if (map->table == cdc_map_treap) {
+    AddTree(static_cast<const struct cdc_treap *>(map->container)->root);
+  } else if (map->table == cdc_map_splay) {
+    AddTree(static_cast<const struct cdc_splay_tree *>(map->container)->root);
+  }
+}
+
+void ShapeCounters::Add(const struct cdc_hash_table *table)
+{
+  AddChains(table->tail->next, table->bcount);
+}
+
+void ShapeCounters::Add(const struct cdc_avl_tree *tree)
+{
+  AddTree(tree->root);
+}
+
+void ShapeCounters::Report(benchmark::State &state, double ops) const
+{
+  if (_trees != 0) {
+    state.counters["height"] =
+        static_cast<double>(_height_sum) / static_cast<double>(_trees);
+    state.counters["avg_depth"] =
+        _nodes != 0
+            ? static_cast<double>(_depth_sum) / static_cast<double>(_nodes)
+            : 0.0;
+  }
+  if (_rotated_trees != 0 && ops != 0) {
+    state.counters["rotations"] = static_cast<double>(_rotations) /
+                                  (static_cast<double>(_rotated_trees) * ops);
+  }
+  if (_tables != 0) {
+    const auto buckets = static_cast<double>(_buckets);
+    uint64_t used = 0;
+    for (auto chains : _chains) {
+      used += chains;
+    }
+    state.counters["load"] = static_cast<double>(_entries) / buckets;
+    state.counters["avg_chain"] =
+        used != 0 ? static_cast<double>(_entries) / static_cast<double>(used)
+                  : 0.0;
+    state.counters["chains_0"] = static_cast<double>(_buckets - used) / buckets;
+    for (size_t i = 1; i <= kMaxChain; ++i) {
+      std::string name = "chains_" + std::to_string(i);
+      if (i == kMaxChain) {
+        name += "+";
+      }
+      state.counters[name] = static_cast<double>(_chains[i - 1]) / buckets;
+    }
+  }
+}
@@ -0,0 +1,202 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+extern "C" {
+#include <cdcontainers/cdc.h>
+}
+
+#include <benchmark/benchmark.h>
+
+#include "benchmarks/typed_avl_tree.hpp"
+#include "benchmarks/typed_hash_table.hpp"
+#include "benchmarks/typed_splay_tree.hpp"
+#include "benchmarks/typed_treap.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Shapes are collected only when enabled with --shape_stats, since walking
+// every map after a phase takes about as long as building it.
+void EnableShapeStats(bool enable);
+bool ShapeStatsEnabled();
+
+// Shape of the maps a benchmark leaves after its timed phase, averaged over
+// maps: height and average node depth of trees, rotations per operation of
+// the typed trees, and the load and chain lengths of chained hash tables.
+// Maps are added before they are released, outside of the timed region.
+// Empty maps have no shape and other maps are ignored.
+class ShapeCounters
+{
+ public:
+  // Chains of kMaxChain entries and longer share the last histogram bin.
+  static constexpr size_t kMaxChain = 4;
+
+  // Counts rotations of a typed tree from here on, so that the rotations of
+  // its build are left out.
+  template <class Map>
+  void Start(Map * /* map */)
+  {
+  }
+  template <class Less>
+  void Start(TypedAvlTree<Less> *map)
+  {
+    map->ResetRotations();
+  }
+  template <class Less>
+  void Start(TypedTreap<Less> *map)
+  {
+    map->ResetRotations();
+  }
+  template <class Less>
+  void Start(TypedSplayTree<Less> *map)
+  {
+    map->ResetRotations();
+  }
+
+  void Add(const struct cdc_map *map);
+  void Add(const struct cdc_hash_table *table);
+  void Add(const struct cdc_avl_tree *tree);
+
+  template <class Map>
+  void Add(const Map * /* map */)
+  {
+  }
+  template <class Hash, class Equal>
+  void Add(const TypedHashTable<Hash, Equal> *map)
+  {
+    AddChains(map->First(), map->BucketCount());
+  }
+  template <class Less>
+  void Add(const TypedAvlTree<Less> *map)
+  {
+    AddTree(map->Root());
+    AddRotations(map->Rotations());
+  }
+  template <class Less>
+  void Add(const TypedTreap<Less> *map)
+  {
+    AddTree(map->Root());
+    AddRotations(map->Rotations());
+  }
+  template <class Less>
+  void Add(const TypedSplayTree<Less> *map)
+  {
+    AddTree(map->Root());
+    AddRotations(map->Rotations());
+  }
+
+  // Sets counters averaged over maps; rotations are per operation for
+  // phases of `ops` operations.
+  void Report(benchmark::State &state, double ops) const;
+
+ private:
+  // Walks a binary tree of nodes with `left` and `right` children. The root
+  // is at depth 1, so the average depth is the number of nodes a successful
+  // lookup visits.
+  template <class Node>
+  void AddTree(const Node *root)
+  {
+    if (!ShapeStatsEnabled() || root == nullptr) {
+      return;
+    }
+
+    size_t height = 0;
+    _stack.clear();
+    _stack.emplace_back(root, 1);
+    while (!_stack.empty()) {
+      auto node = static_cast<const Node *>(_stack.back().first);
+      const size_t depth = _stack.back().second;
+      _stack.pop_back();
+      height = std::max(height, depth);
+      _depth_sum += depth;
+      ++_nodes;
+      if (node->left != nullptr) {
+        _stack.emplace_back(node->left, depth + 1);
+      }
+      if (node->right != nullptr) {
+        _stack.emplace_back(node->right, depth + 1);
+      }
+    }
+    _height_sum += height;
+    ++_trees;
+  }
+
+  // Walks the entries of a hash table laid out as in cdc_hash_table: one
+  // list of all entries, where the entries of a bucket are adjacent, so a
+  // chain is a run of entries of one bucket.
+  template <class Entry>
+  void AddChains(const Entry *first, size_t bcount)
+  {
+    if (!ShapeStatsEnabled() || first == nullptr) {
+      return;
+    }
+
+    size_t bucket = 0;
+    size_t chain = 0;
+    for (const Entry *entry = first; entry != nullptr; entry = entry->next) {
+      const size_t entry_bucket = entry->hash % bcount;
+      if (chain != 0 && entry_bucket != bucket) {
+        AddChain(chain);
+        chain = 0;
+      }
+      bucket = entry_bucket;
+      ++chain;
+    }
+    if (chain != 0) {
+      AddChain(chain);
+    }
+    _buckets += bcount;
+    ++_tables;
+  }
+
+  void AddChain(size_t length)
+  {
+    ++_chains[std::min(length, kMaxChain) - 1];
+    _entries += length;
+  }
+
+  void AddRotations(size_t rotations)
+  {
+    if (!ShapeStatsEnabled()) {
+      return;
+    }
+
+    _rotations += rotations;
+    ++_rotated_trees;
+  }
+
+  std::vector<std::pair<const void *, size_t>> _stack;
+  uint64_t _trees = 0;
+  uint64_t _nodes = 0;
+  uint64_t _height_sum = 0;
+  uint64_t _depth_sum = 0;
+  uint64_t _rotated_trees = 0;
+  uint64_t _rotations = 0;
+  uint64_t _tables = 0;
+  uint64_t _buckets = 0;
+  uint64_t _entries = 0;
+  // Chains of 1, 2, ..., kMaxChain and more entries.
+  uint64_t _chains[kMaxChain] = {};
+};
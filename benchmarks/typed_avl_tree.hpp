@@ -0,0 +1,269 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+
+// The AVL tree of cdc_avl_tree with the comparator as a template parameter,
+// so comparisons are inlined instead of called through cdc_data_info. Nodes,
+// keys and values are laid out and allocated as in cdcontainers.
+template <class Less>
+class TypedAvlTree
+{
+ public:
+  struct Node {
+    Node *parent;
+    Node *left;
+    Node *right;
+    void *key;
+    void *value;
+    unsigned char height;
+  };
+
+  TypedAvlTree() = default;
+  ~TypedAvlTree() { Free(_root); }
+
+  TypedAvlTree(const TypedAvlTree &) = delete;
+  TypedAvlTree &operator=(const TypedAvlTree &) = delete;
+
+  size_t Size() const { return _size; }
+  Node *Root() const { return _root; }
+
+  // Rotations since construction or the last ResetRotations().
+  size_t Rotations() const { return _rotations; }
+  void ResetRotations() { _rotations = 0; }
+
+  bool Get(void *key, void **value) const
+  {
+    Node *node = Find(key);
+    if (node == nullptr) {
+      return false;
+    }
+    *value = node->value;
+    return true;
+  }
+
+  // Returns false if the key is already present.
+  bool Insert(void *key, void *value)
+  {
+    Node *parent = nullptr;
+    Node **link = &_root;
+    while (*link != nullptr) {
+      parent = *link;
+      if (_less(key, parent->key)) {
+        link = &parent->left;
+      } else if (_less(parent->key, key)) {
+        link = &parent->right;
+      } else {
+        return false;
+      }
+    }
+
+    auto node = static_cast<Node *>(std::malloc(sizeof(Node)));
+    node->parent = parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->key = key;
+    node->value = value;
+    node->height = 1;
+    *link = node;
+    ++_size;
+    Rebalance(parent);
+    return true;
+  }
+
+  // Builds the tree from `count` keys that are sorted by Less and distinct, in
+  // linear time and without rotations. Values are null. The tree must be
+  // empty.
+  void Build(void *const *keys, size_t count)
+  {
+    _root = BuildRange(nullptr, keys, count);
+    _size = count;
+  }
+
+  bool Erase(void *key)
+  {
+    Node *node = Find(key);
+    if (node == nullptr) {
+      return false;
+    }
+
+    if (node->left != nullptr && node->right != nullptr) {
+      Node *successor = node->right;
+      while (successor->left != nullptr) {
+        successor = successor->left;
+      }
+      node->key = successor->key;
+      node->value = successor->value;
+      node = successor;
+    }
+
+    Node *child = node->left != nullptr ? node->left : node->right;
+    Node *parent = node->parent;
+    if (child != nullptr) {
+      child->parent = parent;
+    }
+    Replace(parent, node, child);
+    std::free(node);
+    --_size;
+    Rebalance(parent);
+    return true;
+  }
+
+ private:
+  Node *Find(void *key) const
+  {
+    Node *node = _root;
+    while (node != nullptr) {
+      if (_less(key, node->key)) {
+        node = node->left;
+      } else if (_less(node->key, key)) {
+        node = node->right;
+      } else {
+        return node;
+      }
+    }
+    return nullptr;
+  }
+
+  // Makes the middle key the root of the subtree of keys[0, count), so the
+  // heights of its subtrees differ by at most one.
+  static Node *BuildRange(Node *parent, void *const *keys, size_t count)
+  {
+    if (count == 0) {
+      return nullptr;
+    }
+
+    const size_t middle = count / 2;
+    auto node = static_cast<Node *>(std::malloc(sizeof(Node)));
+    node->parent = parent;
+    node->key = keys[middle];
+    node->value = nullptr;
+    node->left = BuildRange(node, keys, middle);
+    node->right = BuildRange(node, keys + middle + 1, count - middle - 1);
+    UpdateHeight(node);
+    return node;
+  }
+
+  static int Height(const Node *node) { return node ? node->height : 0; }
+
+  static void UpdateHeight(Node *node)
+  {
+    node->height = static_cast<unsigned char>(
+        std::max(Height(node->left), Height(node->right)) + 1);
+  }
+
+  void Replace(Node *parent, Node *old_child, Node *new_child)
+  {
+    if (parent == nullptr) {
+      _root = new_child;
+    } else if (parent->left == old_child) {
+      parent->left = new_child;
+    } else {
+      parent->right = new_child;
+    }
+  }
+
+  Node *RotateLeft(Node *node)
+  {
+    ++_rotations;
+    Node *right = node->right;
+    node->right = right->left;
+    if (right->left != nullptr) {
+      right->left->parent = node;
+    }
+    right->parent = node->parent;
+    Replace(node->parent, node, right);
+    right->left = node;
+    node->parent = right;
+    UpdateHeight(node);
+    UpdateHeight(right);
+    return right;
+  }
+
+  Node *RotateRight(Node *node)
+  {
+    ++_rotations;
+    Node *left = node->left;
+    node->left = left->right;
+    if (left->right != nullptr) {
+      left->right->parent = node;
+    }
+    left->parent = node->parent;
+    Replace(node->parent, node, left);
+    left->right = node;
+    node->parent = left;
+    UpdateHeight(node);
+    UpdateHeight(left);
+    return left;
+  }
+
+  // Walks up from `node` until a subtree keeps its height.
+  void Rebalance(Node *node)
+  {
+    while (node != nullptr) {
+      const int balance = Height(node->left) - Height(node->right);
+      if (balance > 1) {
+        if (Height(node->left->left) < Height(node->left->right)) {
+          RotateLeft(node->left);
+        }
+        node = RotateRight(node);
+      } else if (balance < -1) {
+        if (Height(node->right->right) < Height(node->right->left)) {
+          RotateRight(node->right);
+        }
+        node = RotateLeft(node);
+      } else {
+        const unsigned char height = node->height;
+        UpdateHeight(node);
+        if (node->height == height) {
+          return;
+        }
+      }
+      node = node->parent;
+    }
+  }
+
+  static void Free(Node *node)
+  {
+    while (node != nullptr) {
+      if (node->left != nullptr) {
+        node = node->left;
+      } else if (node->right != nullptr) {
+        node = node->right;
+      } else {
+        Node *parent = node->parent;
+        if (parent != nullptr) {
+          (parent->left == node ? parent->left : parent->right) = nullptr;
+        }
+        std::free(node);
+        node = parent;
+      }
+    }
+  }
+
+  Less _less;
+  Node *_root = nullptr;
+  size_t _size = 0;
+  size_t _rotations = 0;
+};
@@ -0,0 +1,200 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+
+// The chained hash table of cdc_hash_table with the hash and the equality as
+// template parameters, so they are inlined instead of called through
+// cdc_data_info. As in cdcontainers, all entries are on one singly linked
+// list behind a sentinel, entries of a bucket are adjacent on it, and a bucket
+// points to the entry before its first one. Hashes are kept in entries.
+template <class Hash, class Equal>
+class TypedHashTable
+{
+ public:
+  struct Entry {
+    Entry *next;
+    void *key;
+    void *value;
+    size_t hash;
+  };
+
+  explicit TypedHashTable(float load_factor = 1.0f)
+      : _buckets(NewBuckets(kMinBuckets)),
+        _bcount(kMinBuckets),
+        _load_factor(load_factor)
+  {
+  }
+
+  ~TypedHashTable()
+  {
+    Entry *entry = _tail.next;
+    while (entry != nullptr) {
+      Entry *next = entry->next;
+      std::free(entry);
+      entry = next;
+    }
+    std::free(_buckets);
+  }
+
+  TypedHashTable(const TypedHashTable &) = delete;
+  TypedHashTable &operator=(const TypedHashTable &) = delete;
+
+  size_t Size() const { return _size; }
+  size_t BucketCount() const { return _bcount; }
+
+  // The first entry of the list of all entries, bucket after bucket.
+  Entry *First() const { return _tail.next; }
+
+  bool Get(void *key, void **value) const
+  {
+    const size_t hash = _hash(key);
+    Entry *prev = FindPrev(hash % _bcount, key, hash);
+    if (prev == nullptr) {
+      return false;
+    }
+    *value = prev->next->value;
+    return true;
+  }
+
+  // Returns false if the key is already present.
+  bool Insert(void *key, void *value)
+  {
+    const size_t hash = _hash(key);
+    size_t bucket = hash % _bcount;
+    if (FindPrev(bucket, key, hash) != nullptr) {
+      return false;
+    }
+
+    if (static_cast<float>(_size + 1) >
+        _load_factor * static_cast<float>(_bcount)) {
+      Rehash(_bcount * 2);
+      bucket = hash % _bcount;
+    }
+    auto entry = static_cast<Entry *>(std::malloc(sizeof(Entry)));
+    entry->key = key;
+    entry->value = value;
+    entry->hash = hash;
+    if (_buckets[bucket] != nullptr) {
+      entry->next = _buckets[bucket]->next;
+      _buckets[bucket]->next = entry;
+    } else {
+      entry->next = _tail.next;
+      _tail.next = entry;
+      if (entry->next != nullptr) {
+        _buckets[entry->next->hash % _bcount] = entry;
+      }
+      _buckets[bucket] = &_tail;
+    }
+    ++_size;
+    return true;
+  }
+
+  bool Erase(void *key)
+  {
+    const size_t hash = _hash(key);
+    const size_t bucket = hash % _bcount;
+    Entry *prev = FindPrev(bucket, key, hash);
+    if (prev == nullptr) {
+      return false;
+    }
+
+    Entry *entry = prev->next;
+    Entry *next = entry->next;
+    const size_t next_bucket = next != nullptr ? next->hash % _bcount : 0;
+    if (next != nullptr && next_bucket != bucket) {
+      // The next bucket now starts right after `prev`.
+      _buckets[next_bucket] = prev;
+    }
+    if (prev == _buckets[bucket] &&
+        (next == nullptr || next_bucket != bucket)) {
+      _buckets[bucket] = nullptr;
+    }
+    prev->next = next;
+    std::free(entry);
+    --_size;
+    return true;
+  }
+
+ private:
+  static constexpr size_t kMinBuckets = 16;
+
+  static Entry **NewBuckets(size_t count)
+  {
+    return static_cast<Entry **>(std::calloc(count, sizeof(Entry *)));
+  }
+
+  // Returns the entry before the one holding `key`, or nullptr.
+  Entry *FindPrev(size_t bucket, void *key, size_t hash) const
+  {
+    Entry *prev = _buckets[bucket];
+    if (prev == nullptr) {
+      return nullptr;
+    }
+
+    for (Entry *entry = prev->next;; prev = entry, entry = entry->next) {
+      if (entry->hash == hash && _equal(entry->key, key)) {
+        return prev;
+      }
+      if (entry->next == nullptr || entry->next->hash % _bcount != bucket) {
+        return nullptr;
+      }
+    }
+  }
+
+  void Rehash(size_t count)
+  {
+    Entry **buckets = NewBuckets(count);
+    Entry *entry = _tail.next;
+    _tail.next = nullptr;
+    size_t first_bucket = 0;
+    while (entry != nullptr) {
+      Entry *next = entry->next;
+      const size_t bucket = entry->hash % count;
+      if (buckets[bucket] == nullptr) {
+        entry->next = _tail.next;
+        _tail.next = entry;
+        buckets[bucket] = &_tail;
+        if (entry->next != nullptr) {
+          buckets[first_bucket] = entry;
+        }
+        first_bucket = bucket;
+      } else {
+        entry->next = buckets[bucket]->next;
+        buckets[bucket]->next = entry;
+      }
+      entry = next;
+    }
+    std::free(_buckets);
+    _buckets = buckets;
+    _bcount = count;
+  }
+
+  Hash _hash;
+  Equal _equal;
+  Entry _tail = {};
+  Entry **_buckets;
+  size_t _bcount;
+  float _load_factor;
+  size_t _size = 0;
+};
@@ -0,0 +1,74 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+extern "C" {
+#include <cdcontainers/cdc.h>
+}
+
+#include "benchmarks/btree.hpp"
+#include "benchmarks/flat_hash_table.hpp"
+#include "benchmarks/typed_avl_tree.hpp"
+#include "benchmarks/typed_hash_table.hpp"
+#include "benchmarks/typed_splay_tree.hpp"
+#include "benchmarks/typed_treap.hpp"
+
+#include <cstddef>
+
+// Less, IsEquil and Hash of utils.hpp as function objects, for the in-tree
+// maps that take them as template parameters.
+struct IntLess {
+  bool operator()(const void *lhs, const void *rhs) const
+  {
+    return CDC_TO_INT(lhs) < CDC_TO_INT(rhs);
+  }
+};
+
+struct IntEqual {
+  bool operator()(const void *lhs, const void *rhs) const
+  {
+    return CDC_TO_INT(lhs) == CDC_TO_INT(rhs);
+  }
+};
+
+struct IntHash {
+  size_t operator()(const void *key) const
+  {
+    return cdc_hash_int(CDC_TO_INT(key));
+  }
+};
+
+// A typed map behind the int-key interface of maps.hpp.
+template <class Map>
+class TypedMap
+{
+ public:
+  void Insert(int key) { _map.Insert(CDC_FROM_INT(key), nullptr); }
+  void Erase(int key) { _map.Erase(CDC_FROM_INT(key)); }
+  bool Find(int key)
+  {
+    void *value = nullptr;
+    return _map.Get(CDC_FROM_INT(key), &value);
+  }
+
+ protected:
+  Map _map;
+};
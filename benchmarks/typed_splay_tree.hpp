@@ -0,0 +1,224 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+
+// The splay tree of cdc_splay_tree with the comparator as a template
+// parameter, so comparisons are inlined instead of called through
+// cdc_data_info. Nodes, keys and values are laid out and allocated as in
+// cdcontainers. Lookups splay the found node to the root.
+template <class Less>
+class TypedSplayTree
+{
+ public:
+  struct Node {
+    Node *parent;
+    Node *left;
+    Node *right;
+    void *key;
+    void *value;
+  };
+
+  TypedSplayTree() = default;
+  ~TypedSplayTree() { Free(_root); }
+
+  TypedSplayTree(const TypedSplayTree &) = delete;
+  TypedSplayTree &operator=(const TypedSplayTree &) = delete;
+
+  size_t Size() const { return _size; }
+  Node *Root() const { return _root; }
+
+  // Rotations since construction or the last ResetRotations().
+  size_t Rotations() const { return _rotations; }
+  void ResetRotations() { _rotations = 0; }
+
+  bool Get(void *key, void **value)
+  {
+    Node *node = Find(key);
+    if (node == nullptr) {
+      return false;
+    }
+    *value = node->value;
+    return true;
+  }
+
+  // Returns false if the key is already present.
+  bool Insert(void *key, void *value)
+  {
+    Node *parent = nullptr;
+    Node **link = &_root;
+    while (*link != nullptr) {
+      parent = *link;
+      if (_less(key, parent->key)) {
+        link = &parent->left;
+      } else if (_less(parent->key, key)) {
+        link = &parent->right;
+      } else {
+        Splay(parent);
+        return false;
+      }
+    }
+
+    auto node = static_cast<Node *>(std::malloc(sizeof(Node)));
+    node->parent = parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->key = key;
+    node->value = value;
+    *link = node;
+    ++_size;
+    Splay(node);
+    return true;
+  }
+
+  bool Erase(void *key)
+  {
+    Node *node = Find(key);
+    if (node == nullptr) {
+      return false;
+    }
+
+    // The node is the root now: the maximum of its left subtree is splayed
+    // to the top of that subtree and takes the right subtree.
+    Node *left = node->left;
+    Node *right = node->right;
+    if (left == nullptr) {
+      _root = right;
+      if (right != nullptr) {
+        right->parent = nullptr;
+      }
+    } else {
+      left->parent = nullptr;
+      _root = left;
+      Node *max = left;
+      while (max->right != nullptr) {
+        max = max->right;
+      }
+      Splay(max);
+      max->right = right;
+      if (right != nullptr) {
+        right->parent = max;
+      }
+    }
+    std::free(node);
+    --_size;
+    return true;
+  }
+
+ private:
+  // Splays the found node, or the last node on the path if there is none.
+  Node *Find(void *key)
+  {
+    Node *node = _root;
+    Node *last = nullptr;
+    while (node != nullptr) {
+      last = node;
+      if (_less(key, node->key)) {
+        node = node->left;
+      } else if (_less(node->key, key)) {
+        node = node->right;
+      } else {
+        Splay(node);
+        return node;
+      }
+    }
+    if (last != nullptr) {
+      Splay(last);
+    }
+    return nullptr;
+  }
+
+  void Replace(Node *parent, Node *old_child, Node *new_child)
+  {
+    if (parent == nullptr) {
+      _root = new_child;
+    } else if (parent->left == old_child) {
+      parent->left = new_child;
+    } else {
+      parent->right = new_child;
+    }
+  }
+
+  // Rotates `node` above its parent.
+  void RotateUp(Node *node)
+  {
+    ++_rotations;
+    Node *parent = node->parent;
+    if (parent->left == node) {
+      parent->left = node->right;
+      if (node->right != nullptr) {
+        node->right->parent = parent;
+      }
+      node->right = parent;
+    } else {
+      parent->right = node->left;
+      if (node->left != nullptr) {
+        node->left->parent = parent;
+      }
+      node->left = parent;
+    }
+    node->parent = parent->parent;
+    Replace(parent->parent, parent, node);
+    parent->parent = node;
+  }
+
+  void Splay(Node *node)
+  {
+    while (node->parent != nullptr) {
+      Node *parent = node->parent;
+      Node *grandparent = parent->parent;
+      if (grandparent == nullptr) {
+        RotateUp(node);
+      } else if ((grandparent->left == parent) == (parent->left == node)) {
+        RotateUp(parent);
+        RotateUp(node);
+      } else {
+        RotateUp(node);
+        RotateUp(node);
+      }
+    }
+  }
+
+  static void Free(Node *node)
+  {
+    while (node != nullptr) {
+      if (node->left != nullptr) {
+        node = node->left;
+      } else if (node->right != nullptr) {
+        node = node->right;
+      } else {
+        Node *parent = node->parent;
+        if (parent != nullptr) {
+          (parent->left == node ? parent->left : parent->right) = nullptr;
+        }
+        std::free(node);
+        node = parent;
+      }
+    }
+  }
+
+  Less _less;
+  Node *_root = nullptr;
+  size_t _size = 0;
+  size_t _rotations = 0;
+};
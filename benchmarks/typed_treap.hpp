@@ -0,0 +1,202 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// The treap of cdc_treap with the comparator as a template parameter, so
+// comparisons are inlined instead of called through cdc_data_info. Nodes,
+// keys and values are laid out and allocated as in cdcontainers.
+template <class Less>
+class TypedTreap
+{
+ public:
+  struct Node {
+    Node *parent;
+    Node *left;
+    Node *right;
+    void *key;
+    void *value;
+    uint32_t priority;
+  };
+
+  TypedTreap() = default;
+  ~TypedTreap() { Free(_root); }
+
+  TypedTreap(const TypedTreap &) = delete;
+  TypedTreap &operator=(const TypedTreap &) = delete;
+
+  size_t Size() const { return _size; }
+  Node *Root() const { return _root; }
+
+  // Rotations since construction or the last ResetRotations().
+  size_t Rotations() const { return _rotations; }
+  void ResetRotations() { _rotations = 0; }
+
+  bool Get(void *key, void **value) const
+  {
+    Node *node = Find(key);
+    if (node == nullptr) {
+      return false;
+    }
+    *value = node->value;
+    return true;
+  }
+
+  // Returns false if the key is already present.
+  bool Insert(void *key, void *value)
+  {
+    Node *parent = nullptr;
+    Node **link = &_root;
+    while (*link != nullptr) {
+      parent = *link;
+      if (_less(key, parent->key)) {
+        link = &parent->left;
+      } else if (_less(parent->key, key)) {
+        link = &parent->right;
+      } else {
+        return false;
+      }
+    }
+
+    auto node = static_cast<Node *>(std::malloc(sizeof(Node)));
+    node->parent = parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->key = key;
+    node->value = value;
+    node->priority = NextPriority();
+    *link = node;
+    ++_size;
+    while (node->parent != nullptr &&
+           node->parent->priority < node->priority) {
+      RotateUp(node);
+    }
+    return true;
+  }
+
+  bool Erase(void *key)
+  {
+    Node *node = Find(key);
+    if (node == nullptr) {
+      return false;
+    }
+
+    while (node->left != nullptr && node->right != nullptr) {
+      RotateUp(node->left->priority > node->right->priority ? node->left
+                                                             : node->right);
+    }
+    Node *child = node->left != nullptr ? node->left : node->right;
+    if (child != nullptr) {
+      child->parent = node->parent;
+    }
+    Replace(node->parent, node, child);
+    std::free(node);
+    --_size;
+    return true;
+  }
+
+ private:
+  Node *Find(void *key) const
+  {
+    Node *node = _root;
+    while (node != nullptr) {
+      if (_less(key, node->key)) {
+        node = node->left;
+      } else if (_less(node->key, key)) {
+        node = node->right;
+      } else {
+        return node;
+      }
+    }
+    return nullptr;
+  }
+
+  // Priorities come from a xorshift generator of the tree, so trees of the
+  // same keys have the same shape.
+  uint32_t NextPriority()
+  {
+    _state ^= _state << 13;
+    _state ^= _state >> 17;
+    _state ^= _state << 5;
+    return _state;
+  }
+
+  void Replace(Node *parent, Node *old_child, Node *new_child)
+  {
+    if (parent == nullptr) {
+      _root = new_child;
+    } else if (parent->left == old_child) {
+      parent->left = new_child;
+    } else {
+      parent->right = new_child;
+    }
+  }
+
+  // Rotates `node` above its parent.
+  void RotateUp(Node *node)
+  {
+    ++_rotations;
+    Node *parent = node->parent;
+    if (parent->left == node) {
+      parent->left = node->right;
+      if (node->right != nullptr) {
+        node->right->parent = parent;
+      }
+      node->right = parent;
+    } else {
+      parent->right = node->left;
+      if (node->left != nullptr) {
+        node->left->parent = parent;
+      }
+      node->left = parent;
+    }
+    node->parent = parent->parent;
+    Replace(parent->parent, parent, node);
+    parent->parent = node;
+  }
+
+  static void Free(Node *node)
+  {
+    while (node != nullptr) {
+      if (node->left != nullptr) {
+        node = node->left;
+      } else if (node->right != nullptr) {
+        node = node->right;
+      } else {
+        Node *parent = node->parent;
+        if (parent != nullptr) {
+          (parent->left == node ? parent->left : parent->right) = nullptr;
+        }
+        std::free(node);
+        node = parent;
+      }
+    }
+  }
+
+  Less _less;
+  Node *_root = nullptr;
+  size_t _size = 0;
+  size_t _rotations = 0;
+  uint32_t _state = 2463534242;
+};
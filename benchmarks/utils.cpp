@@ -24,15 +24,129 @@ extern "C" {
 #include <cdcontainers/cdc.h>
 }
 
+#include <benchmark/benchmark.h>
+
+#include "benchmarks/shape_stats.hpp"
+
+#include <unistd.h>
+
 #include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
 #include <random>
 
+namespace {
+
+uint64_t g_seed = 1;
+KeyDist g_key_dist = KeyDist::kUniform;
+
+// Elements handled by one timed batch and the cap on containers in a pool.
+constexpr size_t kBatchElements = 1 << 14;
+constexpr size_t kMaxBatchSize = 1 << 10;
+
+int RandomInt(std::mt19937_64 &gen)
+{
+  std::uniform_int_distribution<int> dis(std::numeric_limits<int>::min(),
+                                         std::numeric_limits<int>::max());
+  return dis(gen);
+}
+
+// Returns false if `name` names no distribution.
+bool ParseKeyDist(const char *name, KeyDist *dist)
+{
+  static const struct {
+    const char *name;
+    KeyDist dist;
+  } kNames[] = {
+      {"uniform", KeyDist::kUniform},
+      {"sequential", KeyDist::kSequential},
+      {"reverse", KeyDist::kReverse},
+      {"sorted_runs", KeyDist::kSortedRuns},
+      {"zipfian", KeyDist::kZipfian},
+      {"clustered", KeyDist::kClustered},
+  };
+  for (const auto &entry : kNames) {
+    if (std::strcmp(name, entry.name) == 0) {
+      *dist = entry.dist;
+      return true;
+    }
+  }
+  return false;
+}
+
+// glib reads G_SLICE on its first slice allocation, which its library
+// constructor makes before main(), so setting the variable at run time has no
+// effect. Restarts the binary with G_SLICE=always-malloc in its environment,
+// so that glib nodes come from the interposed malloc too.
+void ExecWithMallocSlices(char **argv)
+{
+  const char *slice = std::getenv("G_SLICE");
+  if (slice != nullptr && std::strstr(slice, "always-malloc") != nullptr) {
+    return;
+  }
+  setenv("G_SLICE", "always-malloc", 1);
+  execv("/proc/self/exe", argv);
+  std::fprintf(stderr, "Cannot restart with G_SLICE=always-malloc: %s\n",
+               std::strerror(errno));
+}
+
+}  // namespace
+
+ZipfDistribution::ZipfDistribution(size_t n, double exponent)
+  : _n(static_cast<double>(n)), _s(exponent)
+{
+  _h_integral_x1 = HIntegral(1.5) - 1.0;
+  _h_integral_n = HIntegral(_n + 0.5);
+  _threshold = 2.0 - HIntegralInverse(HIntegral(2.5) - H(2.0));
+}
+
+double ZipfDistribution::H(double x) const
+{
+  return std::exp(-_s * std::log(x));
+}
+
+double ZipfDistribution::HIntegral(double x) const
+{
+  double log_x = std::log(x);
+  return Helper2((1.0 - _s) * log_x) * log_x;
+}
+
+double ZipfDistribution::HIntegralInverse(double x) const
+{
+  double t = std::max(x * (1.0 - _s), -1.0);
+  return std::exp(Helper1(t) * x);
+}
+
+// log(1 + x) / x, stable near zero.
+double ZipfDistribution::Helper1(double x)
+{
+  if (std::abs(x) > 1e-8) {
+    return std::log1p(x) / x;
+  }
+  return 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+// (exp(x) - 1) / x, stable near zero.
+double ZipfDistribution::Helper2(double x)
+{
+  if (std::abs(x) > 1e-8) {
+    return std::expm1(x) / x;
+  }
+  return 1.0 + x * 0.5 * (1.0 + x * (1.0 / 3.0) * (1.0 + 0.25 * x));
+}
+
 RandomSet::RandomSet(size_t size)
 {
   _vec.reserve(size);
   int i = 0;
   std::generate_n(std::back_inserter(_vec), size, [&]() { return ++i; });
-  std::random_shuffle(std::begin(_vec), std::end(_vec));
+  auto gen = MakeRandomEngine({kRandomSetTag, static_cast<uint32_t>(size)});
+  std::shuffle(std::begin(_vec), std::end(_vec), gen);
 }
 
 int RandomSet::Get()
@@ -42,22 +156,141 @@ int RandomSet::Get()
   return back;
 }
 
-int GetRandom()
+void SetKeyDist(KeyDist dist) { g_key_dist = dist; }
+
+KeyDist GetKeyDist() { return g_key_dist; }
+
+KeyStream::KeyStream(size_t size, KeyDist dist)
 {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  static std::uniform_int_distribution<> dis(std::numeric_limits<int>::min(),
-                                             std::numeric_limits<int>::max());
-  return dis(gen);
+  auto gen = MakeRandomEngine({kKeyStreamTag, static_cast<uint32_t>(size),
+                               static_cast<uint32_t>(dist)});
+  _vec.reserve(size);
+  switch (dist) {
+  case KeyDist::kUniform:
+    std::generate_n(std::back_inserter(_vec), size,
+                    [&]() { return RandomInt(gen); });
+    break;
+  case KeyDist::kSequential:
+    _vec.resize(size);
+    std::iota(std::begin(_vec), std::end(_vec), 1);
+    break;
+  case KeyDist::kReverse:
+    _vec.resize(size);
+    std::iota(std::rbegin(_vec), std::rend(_vec), 1);
+    break;
+  case KeyDist::kSortedRuns:
+    std::generate_n(std::back_inserter(_vec), size,
+                    [&]() { return RandomInt(gen); });
+    for (size_t i = 0; i < size; i += kKeyRunLength) {
+      std::sort(std::begin(_vec) + i,
+                std::begin(_vec) + std::min(i + kKeyRunLength, size));
+    }
+    break;
+  case KeyDist::kZipfian: {
+    // Ranks are mapped through a permutation, so the hottest keys are not
+    // also the smallest ones.
+    std::vector<int> keys(size);
+    std::iota(std::begin(keys), std::end(keys), 1);
+    std::shuffle(std::begin(keys), std::end(keys), gen);
+    ZipfDistribution dis(size, kZipfExponent);
+    std::generate_n(std::back_inserter(_vec), size,
+                    [&]() { return keys[dis(gen) - 1]; });
+    break;
+  }
+  case KeyDist::kClustered: {
+    std::uniform_int_distribution<int> base(
+        std::numeric_limits<int>::min(),
+        std::numeric_limits<int>::max() - static_cast<int>(kKeyRunLength));
+    for (size_t i = 0; i < size; i += kKeyRunLength) {
+      int first = base(gen);
+      for (size_t j = i; j < std::min(i + kKeyRunLength, size); ++j) {
+        _vec.push_back(first + static_cast<int>(j - i));
+      }
+    }
+    break;
+  }
+  }
+}
+
+std::vector<size_t> RandomPositions(size_t count, size_t initial_size)
+{
+  auto gen = MakeRandomEngine({kPositionsTag, static_cast<uint32_t>(count),
+                               static_cast<uint32_t>(initial_size)});
+  std::vector<size_t> positions;
+  positions.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    std::uniform_int_distribution<size_t> dis(0, initial_size + i);
+    positions.push_back(dis(gen));
+  }
+  return positions;
+}
+
+std::vector<size_t> RandomIndices(size_t count, size_t size)
+{
+  auto gen = MakeRandomEngine({kIndicesTag, static_cast<uint32_t>(count),
+                               static_cast<uint32_t>(size)});
+  std::uniform_int_distribution<size_t> dis(0, size - 1);
+  std::vector<size_t> indices;
+  indices.reserve(count);
+  std::generate_n(std::back_inserter(indices), count,
+                  [&]() { return dis(gen); });
+  return indices;
+}
+
+size_t GetBatchSize(size_t n)
+{
+  size_t size = kBatchElements / std::max<size_t>(n, 1);
+  return std::max<size_t>(1, std::min(kMaxBatchSize, size));
+}
+
+std::vector<int64_t> Sizes()
+{
+#ifdef BENCH_LARGE_N
+  const int64_t kMinSize = 1 << 4;
+  const int64_t kMaxSize = 1 << 26;
+#else
+  const int64_t kMinSize = 1 << 2;
+  const int64_t kMaxSize = 1 << 17;
+#endif
+  std::vector<int64_t> sizes;
+  for (int64_t n = kMinSize; n <= kMaxSize; n *= 2) {
+    sizes.push_back(n);
+  }
+  return sizes;
+}
+
+void AddSizes(benchmark::internal::Benchmark *benchmark,
+              std::initializer_list<int64_t> params)
+{
+  const auto sizes = Sizes();
+  for (auto param : params) {
+    for (auto n : sizes) {
+      benchmark->Args({n, param});
+    }
+  }
+}
+
+void AddSmallSizes(benchmark::internal::Benchmark *benchmark,
+                   std::initializer_list<int64_t> params)
+{
+  for (auto param : params) {
+    for (int64_t n = 1 << 2; n <= 1 << 17; n *= 2) {
+      benchmark->Args({n, param});
+    }
+  }
 }
 
-size_t GetRandomPos(size_t len)
+void SetSeed(uint64_t seed) { g_seed = seed; }
+
+uint64_t GetSeed() { return g_seed; }
+
+std::mt19937_64 MakeRandomEngine(std::initializer_list<uint32_t> salt)
 {
-  static std::random_device rd;
-  static std::mt19937 gen(rd());
-  static std::uniform_int_distribution<unsigned int> dis(
-      std::numeric_limits<size_t>::max());
-  return dis(gen) % len;
+  std::vector<uint32_t> data = {static_cast<uint32_t>(g_seed),
+                                static_cast<uint32_t>(g_seed >> 32)};
+  data.insert(std::end(data), salt);
+  std::seed_seq seq(std::begin(data), std::end(data));
+  return std::mt19937_64(seq);
 }
 
 int IsEquil(const void *lhs, const void *rhs)
@@ -81,6 +314,12 @@ int CcCmp(const void *lhs, const void *rhs)
   }
 }
 
+int CcElementCmp(const void *lhs, const void *rhs)
+{
+  return CcCmp(*static_cast<void *const *>(lhs),
+               *static_cast<void *const *>(rhs));
+}
+
 size_t Hash(const void *key) { return cdc_hash_int(CDC_TO_INT(key)); }
 
 unsigned int GHash(const void *key)
@@ -92,3 +331,60 @@ size_t CcHash(const void *key, int /* l */, uint32_t /* seed */)
 {
   return cdc_hash_int(CDC_TO_INT(key));
 }
+
+int RunBenchmarks(int argc, char **argv)
+{
+  const char *kSeedFlag = "--seed=";
+  const char *kPerfCountersFlag = "--perf_counters";
+  const char *kAllocStatsFlag = "--alloc_stats";
+  const char *kPoolFlag = "--pool=";
+  const char *kShapeStatsFlag = "--shape_stats";
+  const char *kKeyDistFlag = "--key_dist=";
+  std::vector<char *> args(argv, argv + argc + 1);
+  int j = 1;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], kSeedFlag, std::strlen(kSeedFlag)) == 0) {
+      SetSeed(std::strtoull(argv[i] + std::strlen(kSeedFlag), nullptr, 10));
+    } else if (std::strcmp(argv[i], kPerfCountersFlag) == 0) {
+      EnablePerfCounters(true);
+    } else if (std::strcmp(argv[i], kAllocStatsFlag) == 0) {
+      EnableAllocStats(true);
+    } else if (std::strcmp(argv[i], kShapeStatsFlag) == 0) {
+      EnableShapeStats(true);
+    } else if (std::strncmp(argv[i], kKeyDistFlag,
+                            std::strlen(kKeyDistFlag)) == 0) {
+      const char *name = argv[i] + std::strlen(kKeyDistFlag);
+      KeyDist dist = KeyDist::kUniform;
+      if (!ParseKeyDist(name, &dist)) {
+        std::fprintf(stderr, "Unknown key distribution: %s\n", name);
+        return 1;
+      }
+      SetKeyDist(dist);
+    } else if (std::strncmp(argv[i], kPoolFlag, std::strlen(kPoolFlag)) == 0) {
+      const char *kind = argv[i] + std::strlen(kPoolFlag);
+      if (std::strcmp(kind, "size_class") == 0) {
+        SetPoolKind(PoolKind::kSizeClass);
+      } else if (std::strcmp(kind, "bump") == 0) {
+        SetPoolKind(PoolKind::kBump);
+      } else if (std::strcmp(kind, "none") != 0) {
+        std::fprintf(stderr, "Unknown pool: %s\n", kind);
+        return 1;
+      }
+    } else {
+      argv[j++] = argv[i];
+    }
+  }
+  argc = j;
+  if (AllocStatsEnabled() || GetPoolKind() != PoolKind::kNone) {
+    ExecWithMallocSlices(args.data());
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  std::fprintf(stderr, "Seed: %llu\n",
+               static_cast<unsigned long long>(GetSeed()));
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -20,13 +20,39 @@
 // IN THE SOFTWARE.
 #pragma once
 
+#include <benchmark/benchmark.h>
+
+#include "benchmarks/alloc_stats.hpp"
+#include "benchmarks/perf_counters.hpp"
+#include "benchmarks/pool_alloc.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
+#include <random>
 #include <vector>
 
-#define S(benchmark)                          \
+// Sizes of the default mode. Benchmarks that take time quadratic in the size
+// (e.g. insertion at random positions of an array) always run them, since
+// they would not finish at large-N sizes.
+#define S_SMALL(benchmark)                    \
   benchmark->RangeMultiplier(2)               \
       ->Range(1 << 2, 1 << 12)                \
-      ->DenseRange(1 << 13, 1 << 17, 1 << 14)
+      ->DenseRange(1 << 13, 1 << 17, 1 << 14) \
+      ->UseManualTime()
+
+#ifdef BENCH_LARGE_N
+// Large-N mode (cmake -DBENCH_LARGE_N=ON): powers of two from 1 << 4 to
+// 1 << 26, so that the data of the smallest sizes fits in L1 and of the
+// largest only in DRAM, with the L2 and LLC cliffs in between.
+#define S(benchmark)                                                    \
+  benchmark->RangeMultiplier(2)->Range(1 << 4, 1 << 26)->UseManualTime()
+#else
+#define S(benchmark) S_SMALL(benchmark)
+#endif
 
 class RandomSet
 {
@@ -34,28 +60,284 @@ class RandomSet
   RandomSet(size_t size);
 
   template <typename Fn>
-  void ForEach(Fn &&fn)
+  void ForEach(Fn &&fn) const
   {
     for (auto v : _vec) {
       fn(v);
     }
   }
 
+  // Visits values in the order Get() returns them, without consuming them.
+  template <typename Fn>
+  void ReverseForEach(Fn &&fn) const
+  {
+    for (auto it = _vec.rbegin(); it != _vec.rend(); ++it) {
+      fn(*it);
+    }
+  }
+
   int Get();
 
  private:
   std::vector<int> _vec;
 };
 
-int GetRandom();
+enum class KeyDist {
+  kUniform,     // Uniform over the whole int range.
+  kSequential,  // 1, 2, ..., size.
+  kReverse,     // size, size - 1, ..., 1.
+  kSortedRuns,  // Uniform keys sorted in runs of kKeyRunLength.
+  kZipfian,     // Zipf-distributed keys from [1, size], hot keys scattered.
+  kClustered,   // Runs of kKeyRunLength consecutive keys at random bases.
+};
+
+// Distribution of KeyStream keys, selected with --key_dist=<name>: uniform
+// (default), sequential, reverse, sorted_runs, zipfian or clustered.
+void SetKeyDist(KeyDist dist);
+KeyDist GetKeyDist();
+
+constexpr size_t kKeyRunLength = 64;
+constexpr double kZipfExponent = 0.99;
+
+// Rejection-inversion sampler of Zipf-distributed ranks from [1, n]
+// (W. Hormann, G. Derflinger), works for any positive exponent in O(1) memory.
+class ZipfDistribution
+{
+ public:
+  ZipfDistribution(size_t n, double exponent);
+
+  template <typename Engine>
+  size_t operator()(Engine &gen)
+  {
+    std::uniform_real_distribution<double> dis(0.0, 1.0);
+    for (;;) {
+      double u = _h_integral_n + dis(gen) * (_h_integral_x1 - _h_integral_n);
+      double x = HIntegralInverse(u);
+      double k = std::floor(x + 0.5);
+      k = std::min(std::max(k, 1.0), _n);
+      if (k - x <= _threshold || u >= HIntegral(k + 0.5) - H(k)) {
+        return static_cast<size_t>(k);
+      }
+    }
+  }
+
+ private:
+  double H(double x) const;
+  double HIntegral(double x) const;
+  double HIntegralInverse(double x) const;
+  static double Helper1(double x);
+  static double Helper2(double x);
+
+  double _n;
+  double _s;
+  double _h_integral_x1;
+  double _h_integral_n;
+  double _threshold;
+};
+
+// Keys generated into a contiguous buffer before timing starts, so timed loops
+// only read memory. The keys depend on the seed, the size and the distribution
+// only, so a benchmark sees the same keys however it is filtered.
+class KeyStream
+{
+ public:
+  explicit KeyStream(size_t size) : KeyStream(size, GetKeyDist()) {}
+  KeyStream(size_t size, KeyDist dist);
+
+  const int *begin() const { return _vec.data(); }
+  const int *end() const { return _vec.data() + _vec.size(); }
+
+  int operator[](size_t i) const { return _vec[i]; }
+  size_t Size() const { return _vec.size(); }
+
+ private:
+  std::vector<int> _vec;
+};
+
+// Positions for `count` successive inserts into a container that initially
+// holds `initial_size` elements: the i-th position is less or equal to
+// initial_size + i.
+std::vector<size_t> RandomPositions(size_t count, size_t initial_size);
 
-size_t GetRandomPos(size_t len);
+// Positions of `count` elements drawn uniformly from a container of `size`
+// elements.
+std::vector<size_t> RandomIndices(size_t count, size_t size);
+
+// Number of containers built for one timed batch of n-element operations.
+size_t GetBatchSize(size_t n);
+
+// Powers of two from 1 << 2 to 1 << 17, or from 1 << 4 to 1 << 26 in large-N
+// mode, as S. Benchmarks with more than one argument take their sizes from
+// here, so that BENCH_LARGE_N reaches all of them.
+std::vector<int64_t> Sizes();
+
+// Adds Sizes() for every value of the second argument.
+void AddSizes(benchmark::internal::Benchmark *benchmark,
+              std::initializer_list<int64_t> params);
+
+// Adds sizes from 1 << 2 to 1 << 17 in any mode for every value of the second
+// argument, for benchmarks quadratic in the size, as S_SMALL.
+void AddSmallSizes(benchmark::internal::Benchmark *benchmark,
+                   std::initializer_list<int64_t> params);
+
+// Runs `op` on containers made by `ctor` and released by `dtor`. Containers are
+// built in pools of GetBatchSize(state.range(0)) before the clock starts and
+// released after it stops, and a whole pool is timed with one pair of clock
+// reads, so PauseTiming()/ResumeTiming() are never paid for. The benchmark must
+// be registered with UseManualTime(), as S does. Items processed, perf and
+// allocation counters are reported per operation, taking state.range(0)
+// operations per container.
+// `ctor` and `op` allocate from the pool when one is set with --pool.
+template <typename Ctor, typename Op, typename Dtor>
+void RunBatched(benchmark::State &state, Ctor &&ctor, Op &&op, Dtor &&dtor)
+{
+  using Clock = std::chrono::steady_clock;
+  using Container = decltype(ctor());
+  const auto max_iterations = static_cast<size_t>(state.max_iterations);
+  const size_t batch_size = GetBatchSize(static_cast<size_t>(state.range(0)));
+  std::vector<Container> pool;
+  pool.reserve(batch_size);
+  PerfCounters counters;
+  AllocCounters allocs;
+  size_t done = 0;
+  size_t covered = 0;
+  for (auto _ : state) {
+    if (covered != 0) {
+      --covered;
+      continue;
+    }
+
+    size_t count = std::min(batch_size, max_iterations - done);
+    {
+      const PoolScope scope;
+      for (size_t i = 0; i < count; ++i) {
+        pool.push_back(ctor());
+      }
+    }
+
+    allocs.Start();
+    counters.Start();
+    auto start = Clock::now();
+    {
+      const PoolScope scope;
+      for (auto &c : pool) {
+        op(c);
+      }
+    }
+    auto end = Clock::now();
+    counters.Stop();
+    allocs.Stop(count);
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+
+    for (auto &c : pool) {
+      dtor(c);
+    }
+    pool.clear();
+    done += count;
+    covered = count - 1;
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  counters.Report(state, static_cast<double>(state.range(0)));
+  allocs.Report(state, static_cast<double>(state.range(0)));
+}
+
+// Runs `op` as RunBatched does, but on one pool of containers built before the
+// first batch and released after the last one, for operations that leave the
+// container as it was (lookups, traversals) on containers too expensive to
+// build for every batch, and for steady-state operations that keep its size
+// (FIFO turns of a deque).
+template <typename Ctor, typename Op, typename Dtor>
+void RunReused(benchmark::State &state, Ctor &&ctor, Op &&op, Dtor &&dtor)
+{
+  using Clock = std::chrono::steady_clock;
+  using Container = decltype(ctor());
+  const auto max_iterations = static_cast<size_t>(state.max_iterations);
+  const size_t batch_size = GetBatchSize(static_cast<size_t>(state.range(0)));
+  std::vector<Container> pool;
+  pool.reserve(batch_size);
+  {
+    const PoolScope scope;
+    for (size_t i = 0; i < batch_size; ++i) {
+      pool.push_back(ctor());
+    }
+  }
+
+  PerfCounters counters;
+  AllocCounters allocs;
+  size_t done = 0;
+  size_t covered = 0;
+  for (auto _ : state) {
+    if (covered != 0) {
+      --covered;
+      continue;
+    }
+
+    size_t count = std::min(batch_size, max_iterations - done);
+    allocs.Start();
+    counters.Start();
+    auto start = Clock::now();
+    {
+      const PoolScope scope;
+      for (size_t i = 0; i < count; ++i) {
+        op(pool[i]);
+      }
+    }
+    auto end = Clock::now();
+    counters.Stop();
+    allocs.Stop(count);
+    state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+
+    done += count;
+    covered = count - 1;
+  }
+  for (auto &c : pool) {
+    dtor(c);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  counters.Report(state, static_cast<double>(state.range(0)));
+  allocs.Report(state, static_cast<double>(state.range(0)));
+}
+
+// First salt of every generator, so differently shaped data never shares a
+// random sequence.
+enum SaltTag : uint32_t {
+  kRandomSetTag = 1,
+  kKeyStreamTag,
+  kPositionsTag,
+  kMixedWorkloadTag,
+  kSkewedLookupsTag,
+  kHitRatioLookupsTag,
+  kAgingWorkloadTag,
+  kLatencySamplesTag,
+  kIndicesTag,
+  kListChurnTag,
+  kDequeWorkloadTag,
+};
+
+// Seed for all generated data, set with --seed=<n>.
+void SetSeed(uint64_t seed);
+uint64_t GetSeed();
+
+// Returns an engine seeded with the seed mixed with `salt`.
+std::mt19937_64 MakeRandomEngine(std::initializer_list<uint32_t> salt);
 
 int IsEquil(const void *lhs, const void *rhs);
 
 int Less(const void *lhs, const void *rhs);
 int CcCmp(const void *lhs, const void *rhs);
+// Collections-C and GPtrArray sorts pass pointers to the elements to the
+// comparator, as qsort() does.
+int CcElementCmp(const void *lhs, const void *rhs);
 
 size_t Hash(const void *key);
 unsigned int GHash(const void *key);
 size_t CcHash(const void *key, int /* l */, uint32_t /* seed */);
+
+// Parses own flags (--seed=<n>, --key_dist=<name>, --perf_counters,
+// --alloc_stats, --pool=<kind>, --shape_stats), then runs benchmarks as
+// BENCHMARK_MAIN does.
+int RunBenchmarks(int argc, char **argv);
+
+#define BENCH_MAIN()                                                    \
+  int main(int argc, char **argv) { return RunBenchmarks(argc, argv); } \
+  int main(int, char **)
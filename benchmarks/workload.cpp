@@ -0,0 +1,219 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#include "benchmarks/workload.hpp"
+
+#include "benchmarks/utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <utility>
+
+MixedWorkload::MixedWorkload(size_t resident, size_t count, int64_t get,
+                             int64_t insert, int64_t erase)
+{
+  auto gen = MakeRandomEngine(
+      {kMixedWorkloadTag, static_cast<uint32_t>(resident),
+       static_cast<uint32_t>(count), static_cast<uint32_t>(get),
+       static_cast<uint32_t>(insert), static_cast<uint32_t>(erase)});
+
+  // A key of the universe is present with probability p at the steady state
+  // insert * (1 - p) == erase * p.
+  size_t universe = resident;
+  if (insert > 0 && erase > 0) {
+    double ratio = static_cast<double>(insert + erase) /
+                   static_cast<double>(insert);
+    universe = static_cast<size_t>(
+        std::ceil(static_cast<double>(resident) * ratio));
+  }
+
+  std::vector<int> keys(universe);
+  std::iota(std::begin(keys), std::end(keys), 1);
+  std::shuffle(std::begin(keys), std::end(keys), gen);
+  _resident.assign(std::begin(keys), std::begin(keys) + resident);
+
+  // Present keys and positions of keys in it, to pick and drop keys in O(1).
+  std::vector<int> present(_resident);
+  std::vector<size_t> positions(universe + 1, universe);
+  for (size_t i = 0; i < present.size(); ++i) {
+    positions[present[i]] = i;
+  }
+
+  std::discrete_distribution<int> op_dis({static_cast<double>(get),
+                                          static_cast<double>(insert),
+                                          static_cast<double>(erase)});
+  std::uniform_int_distribution<int> key_dis(1, static_cast<int>(universe));
+  _ops.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto op = static_cast<MapOp>(op_dis(gen));
+    int key = key_dis(gen);
+    if (op == MapOp::kGet && !present.empty()) {
+      std::uniform_int_distribution<size_t> dis(0, present.size() - 1);
+      key = present[dis(gen)];
+    } else if (op == MapOp::kInsert && positions[key] == universe) {
+      positions[key] = present.size();
+      present.push_back(key);
+    } else if (op == MapOp::kErase && positions[key] != universe) {
+      positions[present.back()] = positions[key];
+      present[positions[key]] = present.back();
+      present.pop_back();
+      positions[key] = universe;
+    }
+    _ops.push_back({op, key});
+  }
+}
+
+DequeWorkload::DequeWorkload(size_t resident, size_t count, int64_t read,
+                             int64_t push)
+{
+  auto gen = MakeRandomEngine(
+      {kDequeWorkloadTag, static_cast<uint32_t>(resident),
+       static_cast<uint32_t>(count), static_cast<uint32_t>(read),
+       static_cast<uint32_t>(push)});
+
+  _resident.resize(resident);
+  std::iota(std::begin(_resident), std::end(_resident), 1);
+  std::shuffle(std::begin(_resident), std::end(_resident), gen);
+
+  // A push and its pop are drawn as one with the weight of pushes, so the
+  // operations keep the ratio of the weights. The last operation is a read
+  // if a pair does not fit.
+  std::discrete_distribution<int> op_dis(
+      {static_cast<double>(read), static_cast<double>(push)});
+  std::uniform_int_distribution<int> key_dis(
+      1, std::max(1, static_cast<int>(resident)));
+  _ops.reserve(count);
+  while (_ops.size() < count) {
+    const int key = key_dis(gen);
+    if (op_dis(gen) == 0 || _ops.size() + 2 > count) {
+      _ops.push_back({MapOp::kGet, key});
+    } else {
+      _ops.push_back({MapOp::kInsert, key});
+      _ops.push_back({MapOp::kErase, key});
+    }
+  }
+}
+
+AgingWorkload::AgingWorkload(size_t size, size_t rounds)
+{
+  auto gen = MakeRandomEngine({kAgingWorkloadTag, static_cast<uint32_t>(size),
+                               static_cast<uint32_t>(rounds)});
+
+  // Twice as many keys as the map holds, the first half present at the start.
+  std::vector<int> keys(2 * size);
+  std::iota(std::begin(keys), std::end(keys), 1);
+  std::shuffle(std::begin(keys), std::end(keys), gen);
+  // A fresh map is filled in key order, so its nodes lie one after another in
+  // the order a traversal visits them.
+  _resident.assign(std::begin(keys), std::begin(keys) + size);
+  std::sort(std::begin(_resident), std::end(_resident));
+
+  // Each round erases a random half of the keys before inserting as many
+  // absent ones, since erasing and inserting in turns would get the freed
+  // node back from the allocator every time.
+  const size_t batch = size / 2;
+  _churn.reserve(2 * rounds * batch);
+  for (size_t round = 0; round < rounds; ++round) {
+    std::shuffle(std::begin(keys), std::begin(keys) + size, gen);
+    std::shuffle(std::begin(keys) + size, std::end(keys), gen);
+    for (size_t i = 0; i < batch; ++i) {
+      _churn.push_back({MapOp::kErase, keys[i]});
+    }
+    for (size_t i = 0; i < batch; ++i) {
+      _churn.push_back({MapOp::kInsert, keys[size + i]});
+      std::swap(keys[i], keys[size + i]);
+    }
+  }
+
+  _aged.assign(std::begin(keys), std::begin(keys) + size);
+  std::shuffle(std::begin(_aged), std::end(_aged), gen);
+}
+
+SkewedLookups::SkewedLookups(size_t size, size_t count, Skew skew,
+                             int64_t param)
+{
+  auto gen = MakeRandomEngine(
+      {kSkewedLookupsTag, static_cast<uint32_t>(size),
+       static_cast<uint32_t>(count), static_cast<uint32_t>(skew),
+       static_cast<uint32_t>(param)});
+
+  std::vector<int> keys(size);
+  std::iota(std::begin(keys), std::end(keys), 1);
+  std::shuffle(std::begin(keys), std::end(keys), gen);
+
+  std::uniform_int_distribution<size_t> key_dis(0, size - 1);
+  _keys.reserve(count);
+  switch (skew) {
+  case Skew::kZipf: {
+    ZipfDistribution dis(size, static_cast<double>(param) / 100.0);
+    std::generate_n(std::back_inserter(_keys), count,
+                    [&]() { return keys[dis(gen) - 1]; });
+    break;
+  }
+  case Skew::kHotSet: {
+    const size_t hot = std::max<size_t>(1, size / kHotSetFraction);
+    const auto phases = static_cast<size_t>(std::max<int64_t>(1, param));
+    const size_t phase_length = (count + phases - 1) / phases;
+    std::uniform_int_distribution<size_t> offset_dis(0, size - hot);
+    std::uniform_int_distribution<size_t> hot_dis(0, hot - 1);
+    std::bernoulli_distribution is_hot(kHotSetShare);
+    size_t offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (i % phase_length == 0) {
+        offset = offset_dis(gen);
+      }
+      _keys.push_back(is_hot(gen) ? keys[offset + hot_dis(gen)]
+                                  : keys[key_dis(gen)]);
+    }
+    break;
+  }
+  case Skew::kBurst: {
+    const auto burst = static_cast<size_t>(std::max<int64_t>(1, param));
+    while (_keys.size() < count) {
+      const int key = keys[key_dis(gen)];
+      for (size_t i = 0; i < burst && _keys.size() < count; ++i) {
+        _keys.push_back(key);
+      }
+    }
+    break;
+  }
+  }
+}
+
+std::vector<int> HitRatioLookups(size_t size, size_t count,
+                                 int64_t hit_percent)
+{
+  auto gen = MakeRandomEngine({kHitRatioLookupsTag,
+                               static_cast<uint32_t>(size),
+                               static_cast<uint32_t>(count),
+                               static_cast<uint32_t>(hit_percent)});
+  std::uniform_int_distribution<int> key_dis(1, static_cast<int>(size));
+  std::bernoulli_distribution is_hit(static_cast<double>(hit_percent) / 100.0);
+  std::vector<int> keys;
+  keys.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    const int key = 2 * key_dis(gen);
+    keys.push_back(is_hit(gen) ? key : key - 1);
+  }
+  return keys;
+}
@@ -0,0 +1,135 @@
+// The MIT License (MIT)
+// Copyright (c) 2019 Maksim Andrianov
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class MapOp : uint8_t {
+  kGet,
+  kInsert,
+  kErase,
+};
+
+struct MixedOp {
+  MapOp op;
+  int key;
+};
+
+// Interleaved gets, inserts and erases on a map that holds `resident` keys.
+// Inserts and erases draw keys from a universe sized so that inserts of absent
+// keys and erases of present keys balance at the resident size, gets look up
+// present keys. The ratio of operations is given in weights (e.g. 90, 8, 2).
+class MixedWorkload
+{
+ public:
+  MixedWorkload(size_t resident, size_t count, int64_t get, int64_t insert,
+                int64_t erase);
+
+  // Keys the map holds before the operations.
+  const std::vector<int> &Resident() const { return _resident; }
+
+  const MixedOp *begin() const { return _ops.data(); }
+  const MixedOp *end() const { return _ops.data() + _ops.size(); }
+
+ private:
+  std::vector<int> _resident;
+  std::vector<MixedOp> _ops;
+};
+
+// Front reads, pushes to the back and pops from the front of a deque that
+// holds `resident` keys, `count` operations in all. Every push is followed by
+// a pop that carries the key of the push, so that the deque, and every shard
+// of a deque sharded by key, keeps its size however often the operations are
+// replayed. The ratio of reads to pushes is given in weights (e.g. 90, 5);
+// there are as many pops as pushes.
+class DequeWorkload
+{
+ public:
+  DequeWorkload(size_t resident, size_t count, int64_t read, int64_t push);
+
+  // Keys the deque holds before the operations.
+  const std::vector<int> &Resident() const { return _resident; }
+
+  // Reads are kGet, pushes kInsert and pops kErase.
+  const MixedOp *begin() const { return _ops.data(); }
+  const MixedOp *end() const { return _ops.data() + _ops.size(); }
+
+ private:
+  std::vector<int> _resident;
+  std::vector<MixedOp> _ops;
+};
+
+// Insert and erase churn that ages a map of `size` keys: the map is filled
+// with Resident(), then each of `rounds` rounds of Churn() erases a random
+// half of the keys and inserts as many absent ones. The map ends with as many
+// keys, but its nodes have been freed and allocated again in random order, as
+// in a long-lived map.
+class AgingWorkload
+{
+ public:
+  AgingWorkload(size_t size, size_t rounds);
+
+  // Keys the map holds before the churn, in ascending order.
+  const std::vector<int> &Resident() const { return _resident; }
+  // A batch of erases, then a batch of inserts, per round.
+  const std::vector<MixedOp> &Churn() const { return _churn; }
+  // Keys the map holds after the churn, in random order.
+  const std::vector<int> &Aged() const { return _aged; }
+
+ private:
+  std::vector<int> _resident;
+  std::vector<MixedOp> _churn;
+  std::vector<int> _aged;
+};
+
+enum class Skew : uint8_t {
+  kZipf,    // Zipf-distributed ranks, the exponent is given in hundredths.
+  kHotSet,  // kHotSetShare of lookups go to 1/kHotSetFraction of the keys,
+            // the hot set moves to other keys `param` - 1 times.
+  kBurst,   // Uniform keys, each looked up `param` times in a row.
+};
+
+constexpr size_t kHotSetFraction = 64;
+constexpr double kHotSetShare = 0.9;
+
+// Lookups of `count` keys of a map that holds the keys 1, ..., size. Ranks
+// are mapped through a permutation of the keys, so the hottest keys are not
+// also the smallest ones.
+class SkewedLookups
+{
+ public:
+  SkewedLookups(size_t size, size_t count, Skew skew, int64_t param);
+
+  const int *begin() const { return _keys.data(); }
+  const int *end() const { return _keys.data() + _keys.size(); }
+
+ private:
+  std::vector<int> _keys;
+};
+
+// Lookups of `count` keys of a map that holds the even keys 2, 4, ..., 2 *
+// size: `hit_percent` of them look up keys of the map, the others odd keys
+// between them, so misses end all over the map rather than past its largest
+// key.
+std::vector<int> HitRatioLookups(size_t size, size_t count,
+                                 int64_t hit_percent);
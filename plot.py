@@ -2,11 +2,15 @@
 import collections
 import json
 import os
+import re
 import sys
 
 from cycler import cycler
 from matplotlib import pyplot as plt
 
+# Latency counters of sampled benchmarks, in plotting order.
+PERCENTILES = ["p50", "p90", "p99", "p99.9", "max"]
+
 
 def main():
     assert len(sys.argv) == 3, \
@@ -32,18 +36,67 @@ def main():
             grouped_benchmarks = collections.defaultdict(
                 lambda: collections.defaultdict(dict)
             )
+            scaling_benchmarks = collections.defaultdict(
+                lambda: collections.defaultdict(dict)
+            )
+            latency_benchmarks = collections.defaultdict(
+                lambda: collections.defaultdict(dict)
+            )
 
             for bench in benchmarks:
-                first, last = bench["name"].rsplit("/", maxsplit=1)
-                if "threads" in last:
-                    bench["name"] = first
+                parts = bench["name"].split("/")
+                # Batched benchmarks report the time of their operations as
+                # manual time.
+                manual_time = "manual_time" in parts
+                threads = [int(p.split(":")[1]) for p in parts
+                           if p.startswith("threads:")]
+                parts = [p for p in parts
+                         if p not in ("manual_time", "real_time")
+                         and "threads" not in p]
+                # Named arguments (e.g. get:90, key:16) select a graph of the
+                # operation.
+                args = [p for p in parts if re.fullmatch(r"\w+:-?\d+", p)]
+                parts = [p for p in parts if p not in args]
+                bench["name"] = "/".join(parts)
+
+                # Contended benchmarks are plotted as throughput against the
+                # number of threads, one graph per operation mix.
+                if threads and "items_per_second" in bench:
+                    name = bench["name"].rsplit("/", maxsplit=1)[0]
+                    operation = " ".join([name.split("_")[1]] + args)
+                    name = name.split("_", maxsplit=2)[-1]
+                    scaling_benchmarks[operation][name][threads[0]] = \
+                        float(bench["items_per_second"])
+                    continue
 
                 name, count = bench["name"].rsplit("/", maxsplit=1)
                 name = name.split("_", maxsplit=2)[-1]
                 count = int(count)
                 operation = bench["name"].split("_", maxsplit=2)[1]
-                cpu_time = float(bench["cpu_time"])
-                grouped_benchmarks[operation][name][count] = cpu_time
+                # Searches with a hit ratio are drawn as series of the Search
+                # graph.
+                if operation == "HitSearch":
+                    operation = "Search"
+                    name = " ".join([name] + args)
+                    args = []
+                # Interleaved searches are drawn as one graph per competitor,
+                # with a series per number of lookups in flight.
+                if operation == "InterleavedSearch":
+                    operation = " ".join([operation, name])
+                    name = " ".join(args)
+                    args = []
+                operation = " ".join([operation] + args)
+                time = bench["real_time" if manual_time else "cpu_time"]
+                # Batched benchmarks run N operations per iteration, so their
+                # time is normalized to a single operation.
+                if "items_per_second" in bench:
+                    time = float(time) / count
+                grouped_benchmarks[operation][name][count] = float(time)
+                # Sampled benchmarks are also plotted as latency against the
+                # percentile, one graph per operation and size.
+                if "p50" in bench:
+                    latency_benchmarks[f"{operation} N={count}"][name] = [
+                        float(bench[p]) for p in PERCENTILES]
 
         for operation, v in grouped_benchmarks.items():
             for name, times in v.items():
@@ -52,10 +105,53 @@ def main():
 
             container = os.path.splitext(os.path.basename(filename))[0].split("_")[-1]
             plt.title(f"{container} {operation}")
-            plt.ylabel("Time (ns)")
+            plt.ylabel("Time per operation (ns)")
             plt.xlabel("N")
+            plt.xscale("log", base=2)
+            plt.legend()
+            suffix = operation.replace(" ", "_").replace(":", "")
+            plt.savefig(f"{os.path.splitext(filename)[0]}_{suffix}.svg",
+                        format='svg', dpi=1200)
+            if display_graphs:
+                plt.show()
+            else:
+                plt.close()
+
+        for operation, v in latency_benchmarks.items():
+            # Percentiles are spaced by their number of nines, so that the
+            # tail gets as much room as the median.
+            positions = list(range(len(PERCENTILES)))
+            for name, latencies in v.items():
+                plt.plot(positions, latencies, marker='o', label=name)
+
+            container = os.path.splitext(os.path.basename(filename))[0].split("_")[-1]
+            plt.title(f"{container} {operation}")
+            plt.ylabel("Latency (ns)")
+            plt.xlabel("Percentile")
+            plt.xticks(positions, PERCENTILES)
+            plt.yscale("log")
+            plt.legend()
+            suffix = re.sub(r"[:=]", "", operation.replace(" ", "_"))
+            plt.savefig(f"{os.path.splitext(filename)[0]}_{suffix}.svg",
+                        format='svg', dpi=1200)
+            if display_graphs:
+                plt.show()
+            else:
+                plt.close()
+
+        for operation, v in scaling_benchmarks.items():
+            for name, rates in v.items():
+                threads = sorted(rates.keys())
+                baseline = rates[threads[0]]
+                plt.plot(threads, [rates[t] / baseline for t in threads],
+                         marker='o', label=name)
+
+            plt.title(operation)
+            plt.ylabel("Speedup")
+            plt.xlabel("Threads")
             plt.legend()
-            plt.savefig(f"{os.path.splitext(filename)[0]}_{operation}.svg",
+            suffix = operation.replace(" ", "_").replace(":", "")
+            plt.savefig(f"{os.path.splitext(filename)[0]}_{suffix}.svg",
                         format='svg', dpi=1200)
             if display_graphs:
                 plt.show()